@@ -4,6 +4,7 @@
 #include "fast_double_parser.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <climits>
 #include <cmath>
@@ -15,13 +16,41 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <sstream>
 #include <stdio.h>
+#include <thread>
 #include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "double-conversion/ieee.h"
 #include "double-conversion/double-conversion.h"
 
+// Optional competitors, detected by CMakeLists.txt
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+#include <charconv>
+#endif
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+#include "fast_float/fast_float.h"
+#endif
+
+#ifndef _WIN32
+#include "number_cache.h"
+#endif
+
+#if defined(__x86_64__) || defined(_M_AMD64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCHMARK_HAS_RDTSC 1
+#endif
+
 double findmax_fast_double_parser(const std::vector<std::string>& s) {
   double answer = 0;
   double x;
@@ -34,6 +63,140 @@ double findmax_fast_double_parser(const std::vector<std::string>& s) {
   return answer;
 }
 
+double findmax_fast_double_parser_trusted(const std::vector<std::string>& s) {
+  double answer = 0;
+  double x;
+  for (const std::string & st : s) {
+    bool isok = fast_double_parser::parse_number_trusted(st.c_str(), &x);
+    if (!isok)
+      throw std::runtime_error("bug in findmax_fast_double_parser_trusted");
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
+
+// Only for the demo, whose numbers are all "%f" output in [0, 1].
+double findmax_fast_double_parser_fixed(const std::vector<std::string>& s) {
+  double answer = 0;
+  double x;
+  for (const std::string & st : s) {
+    bool isok = fast_double_parser::parse_fixed<1, 6>(st.c_str(), &x);
+    if (!isok)
+      throw std::runtime_error("bug in findmax_fast_double_parser_fixed");
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
+
+// Same, in the buffer of all numbers: the fraction is read in one word.
+double findmax_fast_double_parser_fixed_buffer(const std::string &buffer) {
+  double answer = 0;
+  double x;
+  const char *p = buffer.data();
+  const char *end = buffer.data() + buffer.size();
+  while (p != end) {
+    p = fast_double_parser::parse_fixed<1, 6>(p, end, &x);
+    if (p == nullptr)
+      throw std::runtime_error("bug in findmax_fast_double_parser_fixed_buffer");
+    answer = answer > x ? answer : x;
+    p++; // the newline
+  }
+  return answer;
+}
+
+// The bulk kernels work on one buffer holding all numbers, one per line.
+double findmax_fast_double_parser_bulk(const std::string &buffer,
+                                       std::vector<double> &values) {
+  size_t count;
+  const char *end = buffer.data() + buffer.size();
+  if (fast_double_parser::parse_numbers(buffer.data(), end, values.data(),
+                                        values.size(), &count) != end) {
+    throw std::runtime_error("bug in findmax_fast_double_parser_bulk");
+  }
+  double answer = 0;
+  for (size_t i = 0; i < count; i++) {
+    answer = answer > values[i] ? answer : values[i];
+  }
+  return answer;
+}
+
+// The stream parser learns the shape of the numbers from the first ones.
+double findmax_fast_double_parser_stream(const std::string &buffer,
+                                         std::vector<double> &values) {
+  fast_double_parser::stream_parser parser;
+  size_t count;
+  const char *end = buffer.data() + buffer.size();
+  if (parser.parse_numbers(buffer.data(), end, values.data(), values.size(),
+                           &count) != end) {
+    throw std::runtime_error("bug in findmax_fast_double_parser_stream");
+  }
+  double answer = 0;
+  for (size_t i = 0; i < count; i++) {
+    answer = answer > values[i] ? answer : values[i];
+  }
+  return answer;
+}
+
+// Folds the values into the maximum as they are parsed, without storing
+// them.
+struct maximum_reducer {
+  double answer;
+  void add(double x) { answer = answer > x ? answer : x; }
+};
+
+double findmax_fast_double_parser_reduce(const std::string &buffer) {
+  maximum_reducer reducer = {0};
+  size_t count;
+  const char *end = buffer.data() + buffer.size();
+  if (fast_double_parser::reduce_numbers(buffer.data(), end, &reducer,
+                                         &count) != end) {
+    throw std::runtime_error("bug in findmax_fast_double_parser_reduce");
+  }
+  return reducer.answer;
+}
+
+// Finds the bounds of all numbers first, then converts them one by one.
+double findmax_fast_double_parser_indexed(const std::string &buffer,
+                                          std::vector<const char *> &starts,
+                                          std::vector<const char *> &ends) {
+  size_t count;
+  const char *end = buffer.data() + buffer.size();
+  if (fast_double_parser::index_numbers(buffer.data(), end, starts.data(),
+                                        ends.data(), starts.size(),
+                                        &count) != end) {
+    throw std::runtime_error("bug in findmax_fast_double_parser_indexed");
+  }
+  double answer = 0;
+  for (size_t i = 0; i < count; i++) {
+    double x;
+    if (fast_double_parser::parse_bounded_number(starts[i], ends[i], end,
+                                                 &x) == nullptr) {
+      throw std::runtime_error("bug in findmax_fast_double_parser_indexed");
+    }
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
+
+// Indexes every number but only converts one in eight, as when a job only
+// reads a few fields of each record.
+double findmax_fast_double_parser_lazy(
+    const std::string &buffer,
+    std::vector<fast_double_parser::lazy_double> &values) {
+  size_t count;
+  const char *end = buffer.data() + buffer.size();
+  if (fast_double_parser::parse_numbers(buffer.data(), end, values.data(),
+                                        values.size(), &count) != end) {
+    throw std::runtime_error("bug in findmax_fast_double_parser_lazy");
+  }
+  // the values we read may all be negative
+  double answer = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < count; i += 8) {
+    double x = values[i].value();
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
 
 double findmax_strtod(const std::vector<std::string>& s) {
   double answer = 0;
@@ -104,6 +267,36 @@ double findmax_doubleconversion(const std::vector<std::string>& s) {
   return answer;
 }
 
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+double findmax_from_chars(const std::vector<std::string>& s) {
+  double answer = 0;
+  double x = 0;
+  for (const std::string& st : s) {
+    auto res = std::from_chars(st.data(), st.data() + st.size(), x);
+    if (res.ec != std::errc()) {
+      throw std::runtime_error("bug in findmax_from_chars");
+    }
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
+#endif
+
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+double findmax_fast_float(const std::vector<std::string>& s) {
+  double answer = 0;
+  double x = 0;
+  for (const std::string& st : s) {
+    auto res = fast_float::from_chars(st.data(), st.data() + st.size(), x);
+    if (res.ec != std::errc()) {
+      throw std::runtime_error("bug in findmax_fast_float");
+    }
+    answer = answer > x ? answer : x;
+  }
+  return answer;
+}
+#endif
+
 // ulp distance
 // Marc B. Reynolds, 2016-2019
 // Public Domain under http://unlicense.org, see link for details.
@@ -168,6 +361,28 @@ void validate(const std::vector<std::string>& s) {
       printf("f64_ulp_dist = %d\n", (int)f64_ulp_dist(x, xref));
       throw std::runtime_error("abseil disagrees");
     }
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+    if ((std::from_chars(st.data(), st.data() + st.size(), x).ec !=
+         std::errc()) ||
+        (xref != x)) {
+      std::cerr << "std::from_chars disagrees" << std::endl;
+      printf("std::from_chars: %.*e\n", DBL_DIG + 1, x);
+      printf("reference: %.*e\n", DBL_DIG + 1, xref);
+      printf("string: %s\n", st.c_str());
+      throw std::runtime_error("std::from_chars disagrees");
+    }
+#endif
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+    if ((fast_float::from_chars(st.data(), st.data() + st.size(), x).ec !=
+         std::errc()) ||
+        (xref != x)) {
+      std::cerr << "fast_float disagrees" << std::endl;
+      printf("fast_float: %.*e\n", DBL_DIG + 1, x);
+      printf("reference: %.*e\n", DBL_DIG + 1, xref);
+      printf("string: %s\n", st.c_str());
+      throw std::runtime_error("fast_float disagrees");
+    }
+#endif
     isok = fast_double_parser::parse_number(st.c_str(), &x);
     if (!isok) {
       printf("fast_double_parser refused to parse %s\n", st.c_str());
@@ -182,6 +397,544 @@ void validate(const std::vector<std::string>& s) {
       throw std::runtime_error("fast_double_parser disagrees");
     }
   }
+  // the stream parser, on all the numbers at once
+  std::string buffer;
+  for (const std::string &st : s) {
+    buffer += st;
+    buffer += '\n';
+  }
+  std::vector<double> values(s.size());
+  size_t count;
+  fast_double_parser::stream_parser stream;
+  if ((stream.parse_numbers(buffer.data(), buffer.data() + buffer.size(),
+                            values.data(), values.size(),
+                            &count) != buffer.data() + buffer.size()) ||
+      (count != s.size())) {
+    throw std::runtime_error("fast_double_parser (stream) refused to parse");
+  }
+  for (size_t i = 0; i < count; i++) {
+    double ref;
+    if (!fast_double_parser::parse_number(s[i].c_str(), &ref) ||
+        (ref != values[i])) {
+      std::cerr << "fast_double_parser (stream) disagrees" << std::endl;
+      printf("string: %s\n", s[i].c_str());
+      throw std::runtime_error("fast_double_parser (stream) disagrees");
+    }
+  }
+}
+
+/**
+ * Latency mode (--latency): every parse is timed on its own, so that we see
+ * the cost of the rare slow inputs, which averages hide.
+ */
+// A timestamp, in cycles of the time-stamp counter when there is one.
+inline uint64_t ticks() {
+#ifdef BENCHMARK_HAS_RDTSC
+  // the fences keep the parse between the two readings
+  _mm_lfence();
+  uint64_t t = __rdtsc();
+  _mm_lfence();
+  return t;
+#else
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count());
+#endif
+}
+
+double ticks_per_nanosecond() {
+  auto t1 = std::chrono::steady_clock::now();
+  uint64_t start = ticks();
+  while (std::chrono::steady_clock::now() - t1 < std::chrono::milliseconds(50)) {
+  }
+  uint64_t stop = ticks();
+  auto t2 = std::chrono::steady_clock::now();
+  return double(stop - start) /
+         double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1)
+                    .count());
+}
+
+// A histogram whose buckets have a width of at most 1/32 of their values,
+// as in HDR histograms: values below 64 have their own bucket, and larger
+// values share a bucket with the values that have the same 6 leading bits.
+class latency_histogram {
+public:
+  latency_histogram() : counts(64 * 32, 0), total(0), largest(0) {}
+
+  void record(uint64_t value) {
+    size_t index = size_t(value);
+    if (value >= 64) {
+      int shift = 63 - fast_double_parser::leading_zeroes(value) - 5;
+      index = size_t(shift) * 32 + size_t(value >> shift);
+    }
+    counts[index]++;
+    total++;
+    largest = std::max(largest, value);
+  }
+
+  // The smallest value of the bucket holding the given fraction of the
+  // values.
+  uint64_t percentile(double fraction) const {
+    uint64_t rank = uint64_t(std::ceil(fraction * double(total)));
+    uint64_t seen = 0;
+    for (size_t index = 0; index < counts.size(); index++) {
+      seen += counts[index];
+      if ((seen >= rank) && (seen > 0)) {
+        if (index < 64) {
+          return index;
+        }
+        size_t shift = index / 32 - 1;
+        return uint64_t(index - shift * 32) << shift;
+      }
+    }
+    return largest;
+  }
+
+  uint64_t count() const { return total; }
+  uint64_t max() const { return largest; }
+
+private:
+  std::vector<uint64_t> counts;
+  uint64_t total;
+  uint64_t largest;
+};
+
+// The path an input takes in fast_double_parser::parse_number.
+enum input_class {
+  clinger_path,      // exact with a double multiplication or division
+  eisel_lemire_path, // a 64-bit product with a power of five
+  refinement_path,   // a 128-bit product, or more than 19 digits
+  fallback_path,     // strtod
+  input_class_count
+};
+
+const char *input_class_names[] = {"fast path", "Eisel-Lemire", "refinement",
+                                   "fallback"};
+
+input_class classify(const std::string &s) {
+  fast_double_parser::decimal_number number;
+  const char *end = fast_double_parser::scan_number<false>(s.c_str(), &number);
+  if (end == nullptr) {
+    return fallback_path;
+  }
+  double x;
+  if (number.many_digits) {
+    return fast_double_parser::compute_float_many_digits(
+               s.c_str(), end, number.exponent, number.negative, &x)
+               ? refinement_path
+               : fallback_path;
+  }
+  // zero, and exponents out of range (signed zeros or errors), are decided
+  // without any arithmetic
+  if ((number.exponent < FASTFLOAT_SMALLEST_POWER) ||
+      (number.exponent > FASTFLOAT_LARGEST_POWER) ||
+      (number.significand == 0) ||
+      ((number.exponent >= -22) && (number.exponent <= 22) &&
+       (number.significand <= 9007199254740991))) {
+    return clinger_path;
+  }
+  uint64_t w = number.significand
+               << fast_double_parser::leading_zeroes(number.significand);
+  fast_double_parser::value128 product = fast_double_parser::full_multiplication(
+      w, fast_double_parser::powers::mantissa_64[number.exponent -
+                                                 FASTFLOAT_SMALLEST_POWER]);
+  return ((product.high & 0x1FF) == 0x1FF) ? refinement_path
+                                            : eisel_lemire_path;
+}
+
+double parse_fast_double_parser(const std::string &s) {
+  double x = 0;
+  if (!fast_double_parser::parse_number(s.c_str(), &x)) {
+    throw std::runtime_error("bug in parse_fast_double_parser");
+  }
+  return x;
+}
+
+double parse_strtod(const std::string &s) {
+#ifdef _WIN32
+  static _locale_t c_locale = _create_locale(LC_ALL, "C");
+  return _strtod_l(s.c_str(), nullptr, c_locale);
+#else
+  static locale_t c_locale = newlocale(LC_ALL_MASK, "C", NULL);
+  return strtod_l(s.c_str(), nullptr, c_locale);
+#endif
+}
+
+double parse_absl_from_chars(const std::string &s) {
+  double x = 0;
+  absl::from_chars(s.data(), s.data() + s.size(), x);
+  return x;
+}
+
+double parse_absl(const std::string &s) {
+  double x = 0;
+  if (!absl::SimpleAtod(s, &x)) {
+    throw std::runtime_error("bug in parse_absl");
+  }
+  return x;
+}
+
+double parse_doubleconversion(const std::string &s) {
+  static const double_conversion::StringToDoubleConverter converter(
+      double_conversion::StringToDoubleConverter::ALLOW_LEADING_SPACES |
+          double_conversion::StringToDoubleConverter::ALLOW_TRAILING_JUNK |
+          double_conversion::StringToDoubleConverter::ALLOW_TRAILING_SPACES,
+      0.0, double_conversion::Double::NaN(), NULL, NULL,
+      double_conversion::StringToDoubleConverter::kNoSeparator);
+  int processed_characters_count;
+  return converter.StringToDouble(s.data(), int(s.size()),
+                                  &processed_characters_count);
+}
+
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+double parse_from_chars(const std::string &s) {
+  double x = 0;
+  std::from_chars(s.data(), s.data() + s.size(), x);
+  return x;
+}
+#endif
+
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+double parse_fast_float(const std::string &s) {
+  double x = 0;
+  fast_float::from_chars(s.data(), s.data() + s.size(), x);
+  return x;
+}
+#endif
+
+struct competitor {
+  const char *name;
+  double (*parse)(const std::string &);
+};
+
+const competitor competitors[] = {
+    {"fast_double_parser", parse_fast_double_parser},
+    {"strtod", parse_strtod},
+    {"abslfromch", parse_absl_from_chars},
+    {"absl", parse_absl},
+    {"double-conv", parse_doubleconversion},
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+    {"from_chars", parse_from_chars},
+#endif
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+    {"fast_float", parse_fast_float},
+#endif
+};
+
+// The cost of reading the timer twice, which we subtract.
+uint64_t timer_overhead() {
+  uint64_t overhead = UINT64_MAX;
+  for (size_t i = 0; i < 10000; i++) {
+    uint64_t t1 = ticks();
+    uint64_t t2 = ticks();
+    overhead = std::min(overhead, t2 - t1);
+  }
+  return overhead;
+}
+
+void latency(const std::vector<std::string> &lines) {
+  double rate = ticks_per_nanosecond();
+  uint64_t overhead = timer_overhead();
+  std::vector<input_class> classes;
+  size_t class_sizes[input_class_count] = {};
+  for (const std::string &line : lines) {
+    classes.push_back(classify(line));
+    class_sizes[classes.back()]++;
+  }
+  printf("latency in ns per value (%.2f ticks per ns, %.1f ns of timer "
+         "overhead subtracted)\n",
+         rate, double(overhead) / rate);
+  for (size_t c = 0; c < input_class_count; c++) {
+    printf("%-14s %zu values\n", input_class_names[c], class_sizes[c]);
+  }
+  printf("\n%-20s %-14s %9s %9s %9s %9s\n", "", "", "p50", "p99", "p99.9",
+         "max");
+  double sink = 0;
+  for (const competitor &comp : competitors) {
+    latency_histogram all;
+    latency_histogram by_class[input_class_count];
+    for (size_t trial = 0; trial < 4; trial++) {
+      for (size_t i = 0; i < lines.size(); i++) {
+        uint64_t t1 = ticks();
+        double x = comp.parse(lines[i]);
+        uint64_t t2 = ticks();
+        sink += x;
+        if (trial == 0) {
+          continue; // warming up
+        }
+        uint64_t elapsed = (t2 - t1 > overhead) ? (t2 - t1 - overhead) : 0;
+        all.record(elapsed);
+        by_class[classes[i]].record(elapsed);
+      }
+    }
+    auto print = [&](const char *label, const latency_histogram &h) {
+      printf("%-20s %-14s %9.1f %9.1f %9.1f %9.1f\n", comp.name, label,
+             double(h.percentile(0.5)) / rate,
+             double(h.percentile(0.99)) / rate,
+             double(h.percentile(0.999)) / rate, double(h.max()) / rate);
+    };
+    print("all", all);
+    for (size_t c = 0; c < input_class_count; c++) {
+      if (by_class[c].count() > 0) {
+        print(input_class_names[c], by_class[c]);
+      }
+    }
+  }
+  if (sink == 0) {
+    printf("bug\n");
+  }
+}
+
+/**
+ * Cold mode (--cold or --cold=G): services often parse a few values at a
+ * time between unrelated work, so the tables and the code of the parser
+ * are cold. Before each group of G values (4 by default) we stream through
+ * a buffer larger than the caches and, with --cold-branches, run decoy
+ * branches that overwrite the branch history. We time the group and report
+ * the cold latency per value.
+ */
+class cache_evictor {
+public:
+  explicit cache_evictor(size_t bytes) : buffer(bytes, 1) {}
+
+  // Writes to every cache line of the buffer, which evicts the lines the
+  // parser used from all levels of the data caches.
+  void evict() {
+    for (size_t i = 0; i < buffer.size(); i += 64) {
+      buffer[i]++;
+    }
+  }
+
+private:
+  std::vector<uint8_t> buffer;
+};
+
+// Many branches, taken at random: the predictors learn nothing useful for
+// the parser.
+never_inline uint64_t decoy_branches(uint64_t state) {
+  uint64_t answer = 0;
+  for (size_t i = 0; i < 100000; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    if (state & 1) {
+      answer += state >> 3;
+    } else if (state & 2) {
+      answer ^= state;
+    } else {
+      answer -= i;
+    }
+  }
+  return answer;
+}
+
+void cold(const std::vector<std::string> &lines, size_t group,
+          bool scramble_branches) {
+  double rate = ticks_per_nanosecond();
+  uint64_t overhead = timer_overhead();
+  // larger than the last-level cache of most machines
+  cache_evictor evictor(size_t(64) << 20);
+  const size_t group_count = std::min<size_t>(500, lines.size() / group);
+  printf("cold latency in ns per value, %zu groups of %zu values, caches "
+         "evicted%s before each group\n",
+         group_count, group, scramble_branches ? " and branches scrambled" : "");
+  printf("\n%-20s %9s %9s %9s %9s %11s\n", "", "p50", "p90", "p99", "max",
+         "hot p50");
+  double sink = 0;
+  uint64_t state = 0x9E3779B97F4A7C15;
+  for (const competitor &comp : competitors) {
+    latency_histogram cold_latency;
+    latency_histogram hot_latency;
+    for (size_t g = 0; g < group_count; g++) {
+      // groups spread over the input
+      size_t first = g * (lines.size() / group_count);
+      evictor.evict();
+      if (scramble_branches) {
+        state += decoy_branches(state) | 1;
+      }
+      for (int pass = 0; pass < 2; pass++) {
+        uint64_t t1 = ticks();
+        for (size_t i = first; i < first + group; i++) {
+          sink += comp.parse(lines[i]);
+        }
+        uint64_t t2 = ticks();
+        uint64_t elapsed = (t2 - t1 > overhead) ? (t2 - t1 - overhead) : 0;
+        // the second pass over the same values is hot
+        (pass == 0 ? cold_latency : hot_latency).record(elapsed / group);
+      }
+    }
+    printf("%-20s %9.1f %9.1f %9.1f %9.1f %11.1f\n", comp.name,
+           double(cold_latency.percentile(0.5)) / rate,
+           double(cold_latency.percentile(0.9)) / rate,
+           double(cold_latency.percentile(0.99)) / rate,
+           double(cold_latency.max()) / rate,
+           double(hot_latency.percentile(0.5)) / rate);
+  }
+  if (sink == 0) {
+    printf("bug\n");
+  }
+}
+
+/**
+ * Scaling mode (--threads or --threads=N): the same parser runs on 1, 2,
+ * 4... N threads at once, each pinned to its own core where we can and
+ * writing to its own output, to see whether concurrent callers slow each
+ * other down (e.g., through the locale in the strtod fallback).
+ */
+void pin_to_core(size_t core) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core % CPU_SETSIZE, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)core;
+#endif
+}
+
+// Returns the time, in ns, for thread_count threads to parse all lines
+// repeats times each.
+double parse_concurrently(const competitor &comp,
+                          const std::vector<std::string> &lines,
+                          size_t thread_count, size_t repeats) {
+  size_t core_count = std::max(1u, std::thread::hardware_concurrency());
+  std::atomic<size_t> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::vector<double>> outputs(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; t++) {
+    threads.emplace_back([&, t]() {
+      pin_to_core(t % core_count);
+      std::vector<double> &out = outputs[t];
+      out.resize(lines.size());
+      ready++;
+      while (!go) {
+      }
+      for (size_t r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < lines.size(); i++) {
+          out[i] = comp.parse(lines[i]);
+        }
+      }
+    });
+  }
+  while (ready != thread_count) {
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  go = true;
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  for (size_t t = 1; t < thread_count; t++) {
+    if (outputs[t] != outputs[0]) {
+      throw std::runtime_error("threads disagree");
+    }
+  }
+  return double(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+}
+
+// Writes the decimal expansion of x * 2^power, exactly.
+std::string times_power_of_two(uint64_t x, int power) {
+  // decimal digits, least significant first
+  std::vector<int> digits;
+  for (; x != 0; x /= 10) {
+    digits.push_back(int(x % 10));
+  }
+  int scaled = (power < 0) ? -power : 0; // x * 2^-k = x * 5^k / 10^k
+  for (int p = 0; p < ((power < 0) ? -power : power); p++) {
+    int carry = 0;
+    for (int &d : digits) {
+      int v = d * ((power < 0) ? 5 : 2) + carry;
+      d = v % 10;
+      carry = v / 10;
+    }
+    if (carry != 0) {
+      digits.push_back(carry);
+    }
+  }
+  std::string answer;
+  for (size_t i = digits.size(); i-- > 0;) {
+    answer += char('0' + digits[i]);
+    if ((i == size_t(scaled)) && (i != 0)) {
+      answer += '.';
+    }
+  }
+  if (size_t(scaled) >= digits.size()) {
+    answer = "0." + std::string(size_t(scaled) - digits.size(), '0') + answer;
+  }
+  return answer;
+}
+
+// Midpoints between two doubles with more than 19 digits: the first 19
+// digits do not decide the result, so they all go to strtod.
+std::vector<std::string> fallback_lines(size_t howmany) {
+  std::vector<std::string> lines;
+  std::mt19937_64 random(1234);
+  for (size_t i = 0; i < howmany; i++) {
+    uint64_t m = (uint64_t(1) << 52) | (random() >> 12);
+    int power = (i % 2 == 0) ? int(18 + random() % 20) : -int(1 + random() % 20);
+    lines.push_back(times_power_of_two(2 * m + 1, power));
+  }
+  return lines;
+}
+
+void scaling(const std::vector<std::string> &lines, size_t max_threads) {
+  std::vector<std::string> no_fallback;
+  for (const std::string &line : lines) {
+    if (classify(line) != fallback_path) {
+      no_fallback.push_back(line);
+    }
+  }
+  std::vector<std::string> fallback = fallback_lines(lines.size());
+  size_t fallback_count = 0;
+  for (const std::string &line : fallback) {
+    fallback_count += (classify(line) == fallback_path);
+  }
+  struct dataset {
+    const char *name;
+    const std::vector<std::string> *lines;
+  };
+  for (const dataset &data :
+       {dataset{"without fallback", &no_fallback},
+        dataset{"midpoints with many digits", &fallback}}) {
+    size_t volume = 0;
+    for (const std::string &line : *data.lines) {
+      volume += line.size();
+    }
+    printf("%s: %zu values", data.name, data.lines->size());
+    if (data.lines == &fallback) {
+      printf(", %zu of them going to strtod", fallback_count);
+    }
+    printf("\n%-20s %8s %14s %11s\n", "", "threads", "aggregate", "efficiency");
+    for (const competitor &comp : competitors) {
+      if ((strcmp(comp.name, "fast_double_parser") != 0) &&
+          (strcmp(comp.name, "strtod") != 0)) {
+        continue;
+      }
+      // repeat small inputs so that each run lasts long enough
+      size_t repeats = 1 + 20000000 / (volume + 1);
+      parse_concurrently(comp, *data.lines, 1, 1); // warming up
+      double single = 0;
+      for (size_t threads = 1;; threads *= 2) {
+        if (threads > max_threads) {
+          threads = max_threads;
+        }
+        double ns = parse_concurrently(comp, *data.lines, threads, repeats);
+        double mbs = double(volume) * double(repeats * threads) * 1000. /
+                     (1024. * 1024.) / ns * 1000000.;
+        if (threads == 1) {
+          single = mbs;
+        }
+        printf("%-20s %8zu %9.2f MB/s %10.0f%%\n", comp.name, threads, mbs,
+               100. * mbs / (single * double(threads)));
+        if (threads == max_threads) {
+          break;
+        }
+      }
+    }
+    printf("\n");
+  }
 }
 
 void printvec(const std::vector<unsigned long long>& evts, size_t volume) {
@@ -191,9 +944,20 @@ void printvec(const std::vector<unsigned long long>& evts, size_t volume) {
          evts[3] * 1.0 / volume, evts[4] * 1.0 / volume);
 }
 
+// Set by demo(), whose numbers all have the format of parse_fixed<1, 6>.
+bool fixed_format_demo = false;
+
 void process(const std::vector<std::string>& lines, size_t volume) {
   double volumeMB = volume / (1024. * 1024.);
   // size_t howmany = lines.size();
+  std::string buffer;
+  for (const std::string &line : lines) {
+    buffer += line;
+    buffer += '\n';
+  }
+  std::vector<double> values(lines.size());
+  std::vector<fast_double_parser::lazy_double> lazy_values(lines.size());
+  std::vector<const char *> starts(lines.size()), ends(lines.size());
   std::chrono::high_resolution_clock::time_point t1, t2;
   double dif, ts;
   for (size_t i = 0; i < 3; i++) {
@@ -208,6 +972,86 @@ void process(const std::vector<std::string>& lines, size_t volume) {
     dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
     if (i > 0)
       printf("fast_double_parser  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    // only meaningful when the input has at most 19 significant digits
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_double_parser_trusted(lines);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_double_parser (trusted)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    if (fixed_format_demo) {
+      t1 = std::chrono::high_resolution_clock::now();
+      ts = findmax_fast_double_parser_fixed(lines);
+      t2 = std::chrono::high_resolution_clock::now();
+      if (ts == 0)
+        printf("bug\n");
+      dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+      if (i > 0)
+        printf("fast_double_parser (parse_fixed<1, 6>)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+      t1 = std::chrono::high_resolution_clock::now();
+      ts = findmax_fast_double_parser_fixed_buffer(buffer);
+      t2 = std::chrono::high_resolution_clock::now();
+      if (ts == 0)
+        printf("bug\n");
+      dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+      if (i > 0)
+        printf("fast_double_parser (parse_fixed<1, 6>, buffer)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    }
+    for (fast_double_parser::instruction_set set :
+         {fast_double_parser::instruction_set::scalar,
+          fast_double_parser::instruction_set::sse42,
+          fast_double_parser::instruction_set::avx2,
+          fast_double_parser::instruction_set::avx512}) {
+      if (!fast_double_parser::force_instruction_set(set)) {
+        continue;
+      }
+      t1 = std::chrono::high_resolution_clock::now();
+      ts = findmax_fast_double_parser_bulk(buffer, values);
+      t2 = std::chrono::high_resolution_clock::now();
+      if (ts == 0)
+        printf("bug\n");
+      dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+      if (i > 0)
+        printf("fast_double_parser (bulk, %s)  %.2f MB/s\n",
+               fast_double_parser::instruction_set_name(set),
+               volumeMB * 1000000000 / dif);
+    }
+    fast_double_parser::force_instruction_set(
+        fast_double_parser::instruction_set::automatic);
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_double_parser_reduce(buffer);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_double_parser (reduce)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_double_parser_stream(buffer, values);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_double_parser (stream)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_double_parser_indexed(buffer, starts, ends);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_double_parser (index, then parse)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_double_parser_lazy(buffer, lazy_values);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_double_parser (lazy, reading 1 in 8)  %.2f MB/s\n", volumeMB * 1000000000 / dif);
     t1 = std::chrono::high_resolution_clock::now();
     ts = findmax_strtod(lines);
     t2 = std::chrono::high_resolution_clock::now();
@@ -240,10 +1084,106 @@ void process(const std::vector<std::string>& lines, size_t volume) {
     dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
     if (i > 0)
       printf("double-conv    %.2f MB/s\n", volumeMB * 1000000000 / dif);
+#ifdef FAST_DOUBLE_PARSER_HAS_FROM_CHARS
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_from_chars(lines);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("from_chars     %.2f MB/s\n", volumeMB * 1000000000 / dif);
+#endif
+#ifdef FAST_DOUBLE_PARSER_HAS_FAST_FLOAT
+    t1 = std::chrono::high_resolution_clock::now();
+    ts = findmax_fast_float(lines);
+    t2 = std::chrono::high_resolution_clock::now();
+    if (ts == 0)
+      printf("bug\n");
+    dif = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    if (i > 0)
+      printf("fast_float     %.2f MB/s\n", volumeMB * 1000000000 / dif);
+#endif
     printf("\n\n");
   }
 }
 
+#ifndef _WIN32
+/**
+ * Cache mode (--cache): loads the file through the cache of parsed files
+ * (tools/number_cache.h), first without its sidecar, so that the text is
+ * hashed and parsed and the sidecar written, then with it, so that the text
+ * is only hashed and the sidecar mapped. Each load is followed by a pass
+ * over the values, since the mapping only reads the sidecar when it is
+ * touched. The sidecar is removed at the end.
+ */
+void cache(const char *filename) {
+  std::string sidecar =
+      number_cache::cached_numbers::sidecar_path(filename);
+  double best[2] = {1e300, 1e300};
+  size_t count = 0;
+  double sink = 0;
+  for (int trial = 0; trial < 10; trial++) {
+    for (int cached = 0; cached < 2; cached++) {
+      if (!cached) {
+        unlink(sidecar.c_str());
+      }
+      auto t1 = std::chrono::steady_clock::now();
+      number_cache::cached_numbers numbers;
+      std::string error;
+      if (!numbers.load(filename, sidecar, &error)) {
+        std::cerr << error << std::endl;
+        return;
+      }
+      double answer = 0;
+      for (size_t i = 0; i < numbers.size(); i++) {
+        answer = answer > numbers.data()[i] ? answer : numbers.data()[i];
+      }
+      auto t2 = std::chrono::steady_clock::now();
+      if (numbers.from_cache() != bool(cached)) {
+        std::cerr << "cannot write " << sidecar << std::endl;
+        return;
+      }
+      sink += answer;
+      count = numbers.size();
+      best[cached] = std::min(
+          best[cached], std::chrono::duration<double>(t2 - t1).count());
+    }
+  }
+  unlink(sidecar.c_str());
+  printf("%zu values, best of 10 loads, each followed by a pass over the "
+         "values\n", count);
+  printf("cold (hash, parse, write sidecar)  %9.3f ms\n", best[0] * 1000);
+  printf("cached (hash, map sidecar)         %9.3f ms\n", best[1] * 1000);
+  printf("speedup                            %9.1f x\n", best[0] / best[1]);
+  if (sink == 0) {
+    printf("bug\n");
+  }
+}
+#endif
+
+bool latency_mode = false;
+// 0 unless in scaling mode
+size_t scaling_threads = 0;
+// 0 unless in cold mode
+size_t cold_group = 0;
+bool cold_branches = false;
+bool cache_mode = false;
+
+// Runs the selected benchmark.
+void run(const std::vector<std::string> &lines, size_t volume) {
+  validate(lines);
+  if (latency_mode) {
+    latency(lines);
+  } else if (scaling_threads > 0) {
+    scaling(lines, scaling_threads);
+  } else if (cold_group > 0) {
+    cold(lines, cold_group, cold_branches);
+  } else {
+    process(lines, volume);
+  }
+}
+
 void fileload(char *filename) {
 
   std::ifstream inputfile(filename);
@@ -260,8 +1200,7 @@ void fileload(char *filename) {
     lines.push_back(line);
   }
   std::cout << "read " << lines.size() << " lines " << std::endl;
-  validate(lines);
-  process(lines, volume);
+  run(lines, volume);
 }
 
 void demo(size_t howmany) {
@@ -275,17 +1214,85 @@ void demo(size_t howmany) {
     volume += line.size();
     lines.push_back(line);
   }
-  validate(lines);
-  process(lines, volume);
+  fixed_format_demo = true;
+  run(lines, volume);
+  fixed_format_demo = false;
+}
+
+// Tells whether the parser is header-only or compiled (the CMake option
+// FAST_DOUBLE_PARSER_COMPILED), and the size of this executable, so that
+// both builds can be compared.
+void print_build(const char *argv0) {
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+  const char *build = "compiled library";
+#else
+  const char *build = "header-only";
+#endif
+  const char *path = argv0;
+#ifdef __linux__
+  path = "/proc/self/exe";
+#endif
+  std::ifstream executable(path, std::ios::binary | std::ios::ate);
+  if (executable) {
+    printf("fast_double_parser: %s build, executable of %lld bytes\n", build,
+           (long long)executable.tellg());
+  } else {
+    printf("fast_double_parser: %s build\n", build);
+  }
 }
 
 int main(int argc, char **argv) {
-  if (argc == 1) {
+  print_build(argv[0]);
+  char *filename = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--latency") == 0) {
+      latency_mode = true;
+    } else if (strncmp(argv[i], "--threads", 9) == 0) {
+      scaling_threads = (argv[i][9] == '=')
+                            ? size_t(strtoull(argv[i] + 10, nullptr, 10))
+                            : std::thread::hardware_concurrency();
+      scaling_threads = std::max(scaling_threads, size_t(1));
+#ifndef _WIN32
+    } else if (strcmp(argv[i], "--cache") == 0) {
+      cache_mode = true;
+#endif
+    } else if (strcmp(argv[i], "--cold-branches") == 0) {
+      cold_branches = true;
+    } else if (strncmp(argv[i], "--cold", 6) == 0) {
+      cold_group = (argv[i][6] == '=')
+                       ? size_t(strtoull(argv[i] + 7, nullptr, 10))
+                       : 4;
+      cold_group = std::max(cold_group, size_t(1));
+    } else {
+      filename = argv[i];
+    }
+  }
+  if (cold_branches && (cold_group == 0)) {
+    cold_group = 4;
+  }
+  if (filename == nullptr) {
     demo(100 * 1000);
     std::cout << "You can also provide a filename: it should contain one "
                  "string per line corresponding to a number"
               << std::endl;
+    std::cout << "With --latency, each parse is timed on its own and we "
+                 "report percentiles."
+              << std::endl;
+    std::cout << "With --threads[=N], we measure the throughput of 1 to N "
+                 "threads parsing at once."
+              << std::endl;
+    std::cout << "With --cold[=G], we evict the caches before each group of "
+                 "G values (and scramble the branch predictors with "
+                 "--cold-branches)."
+              << std::endl;
+#ifndef _WIN32
+    std::cout << "With --cache, we compare parsing the file with loading it "
+                 "from the cache of parsed files."
+              << std::endl;
+  } else if (cache_mode) {
+    cache(filename);
+#endif
   } else {
-    fileload(argv[1]);
+    fileload(filename);
   }
 }
@@ -2,6 +2,7 @@
 #ifndef FAST_DOUBLE_PARSER_H
 #define FAST_DOUBLE_PARSER_H
 
+#include <atomic>
 #include <cfloat>
 #include <cinttypes>
 #include <cmath>
@@ -9,7 +10,11 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <locale.h>
+#include <string>
+#include <type_traits>
+#include <vector>
 #if (defined(sun) || defined(__sun)) 
 #define FAST_DOUBLE_PARSER_SOLARIS
 #endif
@@ -75,6 +80,26 @@ static inline double cygwin_strtod_l(const char* start, char** end) {
 #define WARN_UNUSED __attribute__((warn_unused_result))
 #endif
 
+/**
+ * The bulk kernels have dedicated SSE4.2, AVX2 and AVX-512 implementations
+ * on x86-64. They are compiled with function-level target attributes so that
+ * a baseline x86-64 build still carries all of them: the best one is picked
+ * at runtime. Define FAST_DOUBLE_PARSER_NO_RUNTIME_DISPATCH to only build the
+ * portable kernel.
+ */
+#if (defined(__x86_64__) || defined(_M_AMD64)) &&                              \
+    !defined(FAST_DOUBLE_PARSER_NO_RUNTIME_DISPATCH)
+#define FAST_DOUBLE_PARSER_X86_64_DISPATCH 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define FAST_DOUBLE_PARSER_TARGET(isa)
+#define FAST_DOUBLE_PARSER_FLATTEN
+#else
+#define FAST_DOUBLE_PARSER_TARGET(isa) __attribute__((target(isa)))
+#define FAST_DOUBLE_PARSER_FLATTEN __attribute__((flatten))
+#endif // _MSC_VER
+#endif
+
 namespace fast_double_parser {
 
 /**
@@ -89,19 +114,23 @@ namespace fast_double_parser {
  * If we are solely interested in the *normal* numbers then the
  * smallest value is 2^-1022. We can generate a value larger
  * than 2^-1022 with expressions of the form w * 10^-326.
- * Thus we need to pick FASTFLOAT_SMALLEST_POWER >= -326.
+ * Since compute_float_64 also produces subnormal values, we go down
+ * to -342.
  *********
  * Any number of form w * 10^309 where w>= 1 is going to be 
  * infinite in binary64 so we never need to worry about powers
  * of 5 greater than 308.
  */
-#define FASTFLOAT_SMALLEST_POWER -325
+#define FASTFLOAT_SMALLEST_POWER -342
 #define FASTFLOAT_LARGEST_POWER 308
 
 #ifdef _MSC_VER
 #ifndef really_inline
 #define really_inline __forceinline
 #endif // really_inline
+#ifndef never_inline
+#define never_inline __declspec(noinline)
+#endif // never_inline
 #ifndef unlikely
 #define unlikely(x) x
 #endif // unlikely
@@ -112,8 +141,31 @@ namespace fast_double_parser {
 #ifndef really_inline
 #define really_inline __attribute__((always_inline)) inline
 #endif // really_inline
+#ifndef never_inline
+#define never_inline __attribute__((noinline))
+#endif // never_inline
 #endif // _MSC_VER
 
+// Code that is rarely run: the fallbacks on strtod and the rescan of long
+// significands.
+#if defined(__GNUC__)
+#define FAST_DOUBLE_PARSER_COLD __attribute__((cold))
+#else
+#define FAST_DOUBLE_PARSER_COLD
+#endif
+
+// When FAST_DOUBLE_PARSER_COMPILED_LIBRARY is defined (see the CMake option
+// FAST_DOUBLE_PARSER_COMPILED), the tables, the general conversion and the
+// fallbacks are compiled once, in src/fast_double_parser.cpp, and call sites
+// only inline the scanner and the Clinger fast path. They are templates
+// whose instantiations are declared extern below: the header-only build
+// keeps inlining them.
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+#define FAST_DOUBLE_PARSER_OUT_OF_LINE never_inline
+#else
+#define FAST_DOUBLE_PARSER_OUT_OF_LINE really_inline
+#endif
+
 struct value128 {
   uint64_t low;
   uint64_t high;
@@ -216,11 +268,60 @@ inline int leading_zeroes(uint64_t input_num) {
 #endif // _MSC_VER
 }
 
+/* result might be undefined when input_num is zero */
+inline int trailing_zeroes(uint64_t input_num) {
+#ifdef _MSC_VER
+  unsigned long trailing_zero = 0;
+#ifdef _WIN64
+  (void)_BitScanForward64(&trailing_zero, input_num);
+  return (int)trailing_zero;
+#else
+  if ((uint32_t)input_num == 0) {
+    (void)_BitScanForward(&trailing_zero, (uint32_t)(input_num >> 32));
+    return (int)(trailing_zero + 32);
+  }
+  (void)_BitScanForward(&trailing_zero, (uint32_t)input_num);
+  return (int)trailing_zero;
+#endif // _WIN64
+#else
+  return __builtin_ctzll(input_num);
+#endif // _MSC_VER
+}
+
 static inline bool is_integer(char c) {
   return (c >= '0' && c <= '9');
   // this gets compiled to (uint8_t)(c - '0') <= 9 on all decent compilers
 }
 
+template <typename UC> static inline bool is_integer(UC c) {
+  return (c >= UC('0') && c <= UC('9'));
+}
+
+// The code unit types that parse_number accepts.
+template <typename UC> struct is_supported_code_unit {
+  static const bool value = false;
+};
+template <> struct is_supported_code_unit<char> {
+  static const bool value = true;
+};
+template <> struct is_supported_code_unit<unsigned char> {
+  static const bool value = true;
+};
+template <> struct is_supported_code_unit<wchar_t> {
+  static const bool value = true;
+};
+template <> struct is_supported_code_unit<char16_t> {
+  static const bool value = true;
+};
+template <> struct is_supported_code_unit<char32_t> {
+  static const bool value = true;
+};
+#ifdef __cpp_char8_t
+template <> struct is_supported_code_unit<char8_t> {
+  static const bool value = true;
+};
+#endif // __cpp_char8_t
+
 
 /**
  * When mapping numbers from decimal to binary,
@@ -233,512 +334,523 @@ static inline bool is_integer(char c) {
  * affect the binary significand.
  */ 
 
-// Attempts to compute i * 10^(power) exactly; and if "negative" is
-// true, negate the result.
-// This function will only work in some cases, when it does not work, success is
-// set to false. This should work *most of the time* (like 99% of the time).
-// We assume that power is in the [FASTFLOAT_SMALLEST_POWER,
-// FASTFLOAT_LARGEST_POWER] interval: the caller is responsible for this check.
-really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
-                                      bool *success) {
-
-  // Precomputed powers of ten from 10^0 to 10^22. These
-  // can be represented exactly using the double type.
-  static const double power_of_ten[] = {
-      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
-      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+// The tables are static members of a class template so that a header-only
+// build has a single copy of them, shared by every translation unit.
+template <typename unused = void> struct powers_template {
+  static const uint64_t mantissa_64[];
+  static const uint64_t mantissa_128[];
+};
 
-  // The mantissas of powers of ten from -308 to 308, extended out to sixty four
-  // bits. The array contains the powers of ten approximated
-  // as a 64-bit mantissa. It goes from 10^FASTFLOAT_SMALLEST_POWER to
-  // 10^FASTFLOAT_LARGEST_POWER (inclusively).
-  // The mantissa is truncated, and
-  // never rounded up. Uses about 5KB.
-  static const uint64_t mantissa_64[] = {
-    0xa5ced43b7e3e9188, 0xcf42894a5dce35ea,
-    0x818995ce7aa0e1b2, 0xa1ebfb4219491a1f,
-    0xca66fa129f9b60a6, 0xfd00b897478238d0,
-    0x9e20735e8cb16382, 0xc5a890362fddbc62,
-    0xf712b443bbd52b7b, 0x9a6bb0aa55653b2d,
-    0xc1069cd4eabe89f8, 0xf148440a256e2c76,
-    0x96cd2a865764dbca, 0xbc807527ed3e12bc,
-    0xeba09271e88d976b, 0x93445b8731587ea3,
-    0xb8157268fdae9e4c, 0xe61acf033d1a45df,
-    0x8fd0c16206306bab, 0xb3c4f1ba87bc8696,
-    0xe0b62e2929aba83c, 0x8c71dcd9ba0b4925,
-    0xaf8e5410288e1b6f, 0xdb71e91432b1a24a,
-    0x892731ac9faf056e, 0xab70fe17c79ac6ca,
-    0xd64d3d9db981787d, 0x85f0468293f0eb4e,
-    0xa76c582338ed2621, 0xd1476e2c07286faa,
-    0x82cca4db847945ca, 0xa37fce126597973c,
-    0xcc5fc196fefd7d0c, 0xff77b1fcbebcdc4f,
-    0x9faacf3df73609b1, 0xc795830d75038c1d,
-    0xf97ae3d0d2446f25, 0x9becce62836ac577,
-    0xc2e801fb244576d5, 0xf3a20279ed56d48a,
-    0x9845418c345644d6, 0xbe5691ef416bd60c,
-    0xedec366b11c6cb8f, 0x94b3a202eb1c3f39,
-    0xb9e08a83a5e34f07, 0xe858ad248f5c22c9,
-    0x91376c36d99995be, 0xb58547448ffffb2d,
-    0xe2e69915b3fff9f9, 0x8dd01fad907ffc3b,
-    0xb1442798f49ffb4a, 0xdd95317f31c7fa1d,
-    0x8a7d3eef7f1cfc52, 0xad1c8eab5ee43b66,
-    0xd863b256369d4a40, 0x873e4f75e2224e68,
-    0xa90de3535aaae202, 0xd3515c2831559a83,
-    0x8412d9991ed58091, 0xa5178fff668ae0b6,
-    0xce5d73ff402d98e3, 0x80fa687f881c7f8e,
-    0xa139029f6a239f72, 0xc987434744ac874e,
-    0xfbe9141915d7a922, 0x9d71ac8fada6c9b5,
-    0xc4ce17b399107c22, 0xf6019da07f549b2b,
-    0x99c102844f94e0fb, 0xc0314325637a1939,
-    0xf03d93eebc589f88, 0x96267c7535b763b5,
-    0xbbb01b9283253ca2, 0xea9c227723ee8bcb,
-    0x92a1958a7675175f, 0xb749faed14125d36,
-    0xe51c79a85916f484, 0x8f31cc0937ae58d2,
-    0xb2fe3f0b8599ef07, 0xdfbdcece67006ac9,
-    0x8bd6a141006042bd, 0xaecc49914078536d,
-    0xda7f5bf590966848, 0x888f99797a5e012d,
-    0xaab37fd7d8f58178, 0xd5605fcdcf32e1d6,
-    0x855c3be0a17fcd26, 0xa6b34ad8c9dfc06f,
-    0xd0601d8efc57b08b, 0x823c12795db6ce57,
-    0xa2cb1717b52481ed, 0xcb7ddcdda26da268,
-    0xfe5d54150b090b02, 0x9efa548d26e5a6e1,
-    0xc6b8e9b0709f109a, 0xf867241c8cc6d4c0,
-    0x9b407691d7fc44f8, 0xc21094364dfb5636,
-    0xf294b943e17a2bc4, 0x979cf3ca6cec5b5a,
-    0xbd8430bd08277231, 0xece53cec4a314ebd,
-    0x940f4613ae5ed136, 0xb913179899f68584,
-    0xe757dd7ec07426e5, 0x9096ea6f3848984f,
-    0xb4bca50b065abe63, 0xe1ebce4dc7f16dfb,
-    0x8d3360f09cf6e4bd, 0xb080392cc4349dec,
-    0xdca04777f541c567, 0x89e42caaf9491b60,
-    0xac5d37d5b79b6239, 0xd77485cb25823ac7,
-    0x86a8d39ef77164bc, 0xa8530886b54dbdeb,
-    0xd267caa862a12d66, 0x8380dea93da4bc60,
-    0xa46116538d0deb78, 0xcd795be870516656,
-    0x806bd9714632dff6, 0xa086cfcd97bf97f3,
-    0xc8a883c0fdaf7df0, 0xfad2a4b13d1b5d6c,
-    0x9cc3a6eec6311a63, 0xc3f490aa77bd60fc,
-    0xf4f1b4d515acb93b, 0x991711052d8bf3c5,
-    0xbf5cd54678eef0b6, 0xef340a98172aace4,
-    0x9580869f0e7aac0e, 0xbae0a846d2195712,
-    0xe998d258869facd7, 0x91ff83775423cc06,
-    0xb67f6455292cbf08, 0xe41f3d6a7377eeca,
-    0x8e938662882af53e, 0xb23867fb2a35b28d,
-    0xdec681f9f4c31f31, 0x8b3c113c38f9f37e,
-    0xae0b158b4738705e, 0xd98ddaee19068c76,
-    0x87f8a8d4cfa417c9, 0xa9f6d30a038d1dbc,
-    0xd47487cc8470652b, 0x84c8d4dfd2c63f3b,
-    0xa5fb0a17c777cf09, 0xcf79cc9db955c2cc,
-    0x81ac1fe293d599bf, 0xa21727db38cb002f,
-    0xca9cf1d206fdc03b, 0xfd442e4688bd304a,
-    0x9e4a9cec15763e2e, 0xc5dd44271ad3cdba,
-    0xf7549530e188c128, 0x9a94dd3e8cf578b9,
-    0xc13a148e3032d6e7, 0xf18899b1bc3f8ca1,
-    0x96f5600f15a7b7e5, 0xbcb2b812db11a5de,
-    0xebdf661791d60f56, 0x936b9fcebb25c995,
-    0xb84687c269ef3bfb, 0xe65829b3046b0afa,
-    0x8ff71a0fe2c2e6dc, 0xb3f4e093db73a093,
-    0xe0f218b8d25088b8, 0x8c974f7383725573,
-    0xafbd2350644eeacf, 0xdbac6c247d62a583,
-    0x894bc396ce5da772, 0xab9eb47c81f5114f,
-    0xd686619ba27255a2, 0x8613fd0145877585,
-    0xa798fc4196e952e7, 0xd17f3b51fca3a7a0,
-    0x82ef85133de648c4, 0xa3ab66580d5fdaf5,
-    0xcc963fee10b7d1b3, 0xffbbcfe994e5c61f,
-    0x9fd561f1fd0f9bd3, 0xc7caba6e7c5382c8,
-    0xf9bd690a1b68637b, 0x9c1661a651213e2d,
-    0xc31bfa0fe5698db8, 0xf3e2f893dec3f126,
-    0x986ddb5c6b3a76b7, 0xbe89523386091465,
-    0xee2ba6c0678b597f, 0x94db483840b717ef,
-    0xba121a4650e4ddeb, 0xe896a0d7e51e1566,
-    0x915e2486ef32cd60, 0xb5b5ada8aaff80b8,
-    0xe3231912d5bf60e6, 0x8df5efabc5979c8f,
-    0xb1736b96b6fd83b3, 0xddd0467c64bce4a0,
-    0x8aa22c0dbef60ee4, 0xad4ab7112eb3929d,
-    0xd89d64d57a607744, 0x87625f056c7c4a8b,
-    0xa93af6c6c79b5d2d, 0xd389b47879823479,
-    0x843610cb4bf160cb, 0xa54394fe1eedb8fe,
-    0xce947a3da6a9273e, 0x811ccc668829b887,
-    0xa163ff802a3426a8, 0xc9bcff6034c13052,
-    0xfc2c3f3841f17c67, 0x9d9ba7832936edc0,
-    0xc5029163f384a931, 0xf64335bcf065d37d,
-    0x99ea0196163fa42e, 0xc06481fb9bcf8d39,
-    0xf07da27a82c37088, 0x964e858c91ba2655,
-    0xbbe226efb628afea, 0xeadab0aba3b2dbe5,
-    0x92c8ae6b464fc96f, 0xb77ada0617e3bbcb,
-    0xe55990879ddcaabd, 0x8f57fa54c2a9eab6,
-    0xb32df8e9f3546564, 0xdff9772470297ebd,
-    0x8bfbea76c619ef36, 0xaefae51477a06b03,
-    0xdab99e59958885c4, 0x88b402f7fd75539b,
-    0xaae103b5fcd2a881, 0xd59944a37c0752a2,
-    0x857fcae62d8493a5, 0xa6dfbd9fb8e5b88e,
-    0xd097ad07a71f26b2, 0x825ecc24c873782f,
-    0xa2f67f2dfa90563b, 0xcbb41ef979346bca,
-    0xfea126b7d78186bc, 0x9f24b832e6b0f436,
-    0xc6ede63fa05d3143, 0xf8a95fcf88747d94,
-    0x9b69dbe1b548ce7c, 0xc24452da229b021b,
-    0xf2d56790ab41c2a2, 0x97c560ba6b0919a5,
-    0xbdb6b8e905cb600f, 0xed246723473e3813,
-    0x9436c0760c86e30b, 0xb94470938fa89bce,
-    0xe7958cb87392c2c2, 0x90bd77f3483bb9b9,
-    0xb4ecd5f01a4aa828, 0xe2280b6c20dd5232,
-    0x8d590723948a535f, 0xb0af48ec79ace837,
-    0xdcdb1b2798182244, 0x8a08f0f8bf0f156b,
-    0xac8b2d36eed2dac5, 0xd7adf884aa879177,
-    0x86ccbb52ea94baea, 0xa87fea27a539e9a5,
-    0xd29fe4b18e88640e, 0x83a3eeeef9153e89,
-    0xa48ceaaab75a8e2b, 0xcdb02555653131b6,
-    0x808e17555f3ebf11, 0xa0b19d2ab70e6ed6,
-    0xc8de047564d20a8b, 0xfb158592be068d2e,
-    0x9ced737bb6c4183d, 0xc428d05aa4751e4c,
-    0xf53304714d9265df, 0x993fe2c6d07b7fab,
-    0xbf8fdb78849a5f96, 0xef73d256a5c0f77c,
-    0x95a8637627989aad, 0xbb127c53b17ec159,
-    0xe9d71b689dde71af, 0x9226712162ab070d,
-    0xb6b00d69bb55c8d1, 0xe45c10c42a2b3b05,
-    0x8eb98a7a9a5b04e3, 0xb267ed1940f1c61c,
-    0xdf01e85f912e37a3, 0x8b61313bbabce2c6,
-    0xae397d8aa96c1b77, 0xd9c7dced53c72255,
-    0x881cea14545c7575, 0xaa242499697392d2,
-    0xd4ad2dbfc3d07787, 0x84ec3c97da624ab4,
-    0xa6274bbdd0fadd61, 0xcfb11ead453994ba,
-    0x81ceb32c4b43fcf4, 0xa2425ff75e14fc31,
-    0xcad2f7f5359a3b3e, 0xfd87b5f28300ca0d,
-    0x9e74d1b791e07e48, 0xc612062576589dda,
-    0xf79687aed3eec551, 0x9abe14cd44753b52,
-    0xc16d9a0095928a27, 0xf1c90080baf72cb1,
-    0x971da05074da7bee, 0xbce5086492111aea,
-    0xec1e4a7db69561a5, 0x9392ee8e921d5d07,
-    0xb877aa3236a4b449, 0xe69594bec44de15b,
-    0x901d7cf73ab0acd9, 0xb424dc35095cd80f,
-    0xe12e13424bb40e13, 0x8cbccc096f5088cb,
-    0xafebff0bcb24aafe, 0xdbe6fecebdedd5be,
-    0x89705f4136b4a597, 0xabcc77118461cefc,
-    0xd6bf94d5e57a42bc, 0x8637bd05af6c69b5,
-    0xa7c5ac471b478423, 0xd1b71758e219652b,
-    0x83126e978d4fdf3b, 0xa3d70a3d70a3d70a,
-    0xcccccccccccccccc, 0x8000000000000000,
-    0xa000000000000000, 0xc800000000000000,
-    0xfa00000000000000, 0x9c40000000000000,
-    0xc350000000000000, 0xf424000000000000,
-    0x9896800000000000, 0xbebc200000000000,
-    0xee6b280000000000, 0x9502f90000000000,
-    0xba43b74000000000, 0xe8d4a51000000000,
-    0x9184e72a00000000, 0xb5e620f480000000,
-    0xe35fa931a0000000, 0x8e1bc9bf04000000,
-    0xb1a2bc2ec5000000, 0xde0b6b3a76400000,
-    0x8ac7230489e80000, 0xad78ebc5ac620000,
-    0xd8d726b7177a8000, 0x878678326eac9000,
-    0xa968163f0a57b400, 0xd3c21bcecceda100,
-    0x84595161401484a0, 0xa56fa5b99019a5c8,
-    0xcecb8f27f4200f3a, 0x813f3978f8940984,
-    0xa18f07d736b90be5, 0xc9f2c9cd04674ede,
-    0xfc6f7c4045812296, 0x9dc5ada82b70b59d,
-    0xc5371912364ce305, 0xf684df56c3e01bc6,
-    0x9a130b963a6c115c, 0xc097ce7bc90715b3,
-    0xf0bdc21abb48db20, 0x96769950b50d88f4,
-    0xbc143fa4e250eb31, 0xeb194f8e1ae525fd,
-    0x92efd1b8d0cf37be, 0xb7abc627050305ad,
-    0xe596b7b0c643c719, 0x8f7e32ce7bea5c6f,
-    0xb35dbf821ae4f38b, 0xe0352f62a19e306e,
-    0x8c213d9da502de45, 0xaf298d050e4395d6,
-    0xdaf3f04651d47b4c, 0x88d8762bf324cd0f,
-    0xab0e93b6efee0053, 0xd5d238a4abe98068,
-    0x85a36366eb71f041, 0xa70c3c40a64e6c51,
-    0xd0cf4b50cfe20765, 0x82818f1281ed449f,
-    0xa321f2d7226895c7, 0xcbea6f8ceb02bb39,
-    0xfee50b7025c36a08, 0x9f4f2726179a2245,
-    0xc722f0ef9d80aad6, 0xf8ebad2b84e0d58b,
-    0x9b934c3b330c8577, 0xc2781f49ffcfa6d5,
-    0xf316271c7fc3908a, 0x97edd871cfda3a56,
-    0xbde94e8e43d0c8ec, 0xed63a231d4c4fb27,
-    0x945e455f24fb1cf8, 0xb975d6b6ee39e436,
-    0xe7d34c64a9c85d44, 0x90e40fbeea1d3a4a,
-    0xb51d13aea4a488dd, 0xe264589a4dcdab14,
-    0x8d7eb76070a08aec, 0xb0de65388cc8ada8,
-    0xdd15fe86affad912, 0x8a2dbf142dfcc7ab,
-    0xacb92ed9397bf996, 0xd7e77a8f87daf7fb,
-    0x86f0ac99b4e8dafd, 0xa8acd7c0222311bc,
-    0xd2d80db02aabd62b, 0x83c7088e1aab65db,
-    0xa4b8cab1a1563f52, 0xcde6fd5e09abcf26,
-    0x80b05e5ac60b6178, 0xa0dc75f1778e39d6,
-    0xc913936dd571c84c, 0xfb5878494ace3a5f,
-    0x9d174b2dcec0e47b, 0xc45d1df942711d9a,
-    0xf5746577930d6500, 0x9968bf6abbe85f20,
-    0xbfc2ef456ae276e8, 0xefb3ab16c59b14a2,
-    0x95d04aee3b80ece5, 0xbb445da9ca61281f,
-    0xea1575143cf97226, 0x924d692ca61be758,
-    0xb6e0c377cfa2e12e, 0xe498f455c38b997a,
-    0x8edf98b59a373fec, 0xb2977ee300c50fe7,
-    0xdf3d5e9bc0f653e1, 0x8b865b215899f46c,
-    0xae67f1e9aec07187, 0xda01ee641a708de9,
-    0x884134fe908658b2, 0xaa51823e34a7eede,
-    0xd4e5e2cdc1d1ea96, 0x850fadc09923329e,
-    0xa6539930bf6bff45, 0xcfe87f7cef46ff16,
-    0x81f14fae158c5f6e, 0xa26da3999aef7749,
-    0xcb090c8001ab551c, 0xfdcb4fa002162a63,
-    0x9e9f11c4014dda7e, 0xc646d63501a1511d,
-    0xf7d88bc24209a565, 0x9ae757596946075f,
-    0xc1a12d2fc3978937, 0xf209787bb47d6b84,
-    0x9745eb4d50ce6332, 0xbd176620a501fbff,
-    0xec5d3fa8ce427aff, 0x93ba47c980e98cdf,
-    0xb8a8d9bbe123f017, 0xe6d3102ad96cec1d,
-    0x9043ea1ac7e41392, 0xb454e4a179dd1877,
-    0xe16a1dc9d8545e94, 0x8ce2529e2734bb1d,
-    0xb01ae745b101e9e4, 0xdc21a1171d42645d,
-    0x899504ae72497eba, 0xabfa45da0edbde69,
-    0xd6f8d7509292d603, 0x865b86925b9bc5c2,
-    0xa7f26836f282b732, 0xd1ef0244af2364ff,
-    0x8335616aed761f1f, 0xa402b9c5a8d3a6e7,
-    0xcd036837130890a1, 0x802221226be55a64,
-    0xa02aa96b06deb0fd, 0xc83553c5c8965d3d,
-    0xfa42a8b73abbf48c, 0x9c69a97284b578d7,
-    0xc38413cf25e2d70d, 0xf46518c2ef5b8cd1,
-    0x98bf2f79d5993802, 0xbeeefb584aff8603,
-    0xeeaaba2e5dbf6784, 0x952ab45cfa97a0b2,
-    0xba756174393d88df, 0xe912b9d1478ceb17,
-    0x91abb422ccb812ee, 0xb616a12b7fe617aa,
-    0xe39c49765fdf9d94, 0x8e41ade9fbebc27d,
-    0xb1d219647ae6b31c, 0xde469fbd99a05fe3,
-    0x8aec23d680043bee, 0xada72ccc20054ae9,
-    0xd910f7ff28069da4, 0x87aa9aff79042286,
-    0xa99541bf57452b28, 0xd3fa922f2d1675f2,
-    0x847c9b5d7c2e09b7, 0xa59bc234db398c25,
-    0xcf02b2c21207ef2e, 0x8161afb94b44f57d,
-    0xa1ba1ba79e1632dc, 0xca28a291859bbf93,
-    0xfcb2cb35e702af78, 0x9defbf01b061adab,
-    0xc56baec21c7a1916, 0xf6c69a72a3989f5b,
-    0x9a3c2087a63f6399, 0xc0cb28a98fcf3c7f,
-    0xf0fdf2d3f3c30b9f, 0x969eb7c47859e743,
-    0xbc4665b596706114, 0xeb57ff22fc0c7959,
-    0x9316ff75dd87cbd8, 0xb7dcbf5354e9bece,
-    0xe5d3ef282a242e81, 0x8fa475791a569d10,
-    0xb38d92d760ec4455, 0xe070f78d3927556a,
-    0x8c469ab843b89562, 0xaf58416654a6babb,
-    0xdb2e51bfe9d0696a, 0x88fcf317f22241e2,
-    0xab3c2fddeeaad25a, 0xd60b3bd56a5586f1,
-    0x85c7056562757456, 0xa738c6bebb12d16c,
-    0xd106f86e69d785c7, 0x82a45b450226b39c,
-    0xa34d721642b06084, 0xcc20ce9bd35c78a5,
-    0xff290242c83396ce, 0x9f79a169bd203e41,
-    0xc75809c42c684dd1, 0xf92e0c3537826145,
-    0x9bbcc7a142b17ccb, 0xc2abf989935ddbfe,
-    0xf356f7ebf83552fe, 0x98165af37b2153de,
-    0xbe1bf1b059e9a8d6, 0xeda2ee1c7064130c,
-    0x9485d4d1c63e8be7, 0xb9a74a0637ce2ee1,
-    0xe8111c87c5c1ba99, 0x910ab1d4db9914a0,
-    0xb54d5e4a127f59c8, 0xe2a0b5dc971f303a,
-    0x8da471a9de737e24, 0xb10d8e1456105dad,
-    0xdd50f1996b947518, 0x8a5296ffe33cc92f,
-    0xace73cbfdc0bfb7b, 0xd8210befd30efa5a,
-    0x8714a775e3e95c78, 0xa8d9d1535ce3b396,
-    0xd31045a8341ca07c, 0x83ea2b892091e44d,
-    0xa4e4b66b68b65d60, 0xce1de40642e3f4b9,
-    0x80d2ae83e9ce78f3, 0xa1075a24e4421730,
-    0xc94930ae1d529cfc, 0xfb9b7cd9a4a7443c,
-    0x9d412e0806e88aa5, 0xc491798a08a2ad4e,
-    0xf5b5d7ec8acb58a2, 0x9991a6f3d6bf1765,
-    0xbff610b0cc6edd3f, 0xeff394dcff8a948e,
-    0x95f83d0a1fb69cd9, 0xbb764c4ca7a4440f,
-    0xea53df5fd18d5513, 0x92746b9be2f8552c,
-    0xb7118682dbb66a77, 0xe4d5e82392a40515,
-    0x8f05b1163ba6832d, 0xb2c71d5bca9023f8,
-    0xdf78e4b2bd342cf6, 0x8bab8eefb6409c1a,
-    0xae9672aba3d0c320, 0xda3c0f568cc4f3e8,
-    0x8865899617fb1871, 0xaa7eebfb9df9de8d,
-    0xd51ea6fa85785631, 0x8533285c936b35de,
-    0xa67ff273b8460356, 0xd01fef10a657842c,
-    0x8213f56a67f6b29b, 0xa298f2c501f45f42,
-    0xcb3f2f7642717713, 0xfe0efb53d30dd4d7,
-    0x9ec95d1463e8a506, 0xc67bb4597ce2ce48,
-    0xf81aa16fdc1b81da, 0x9b10a4e5e9913128,
-    0xc1d4ce1f63f57d72, 0xf24a01a73cf2dccf,
-    0x976e41088617ca01, 0xbd49d14aa79dbc82,
-    0xec9c459d51852ba2, 0x93e1ab8252f33b45,
-    0xb8da1662e7b00a17, 0xe7109bfba19c0c9d,
-    0x906a617d450187e2, 0xb484f9dc9641e9da,
-    0xe1a63853bbd26451, 0x8d07e33455637eb2,
-    0xb049dc016abc5e5f, 0xdc5c5301c56b75f7,
-    0x89b9b3e11b6329ba, 0xac2820d9623bf429,
-    0xd732290fbacaf133, 0x867f59a9d4bed6c0,
-    0xa81f301449ee8c70, 0xd226fc195c6a2f8c,
-    0x83585d8fd9c25db7, 0xa42e74f3d032f525,
-    0xcd3a1230c43fb26f, 0x80444b5e7aa7cf85,
-    0xa0555e361951c366, 0xc86ab5c39fa63440,
-    0xfa856334878fc150, 0x9c935e00d4b9d8d2,
-    0xc3b8358109e84f07, 0xf4a642e14c6262c8,
-    0x98e7e9cccfbd7dbd, 0xbf21e44003acdd2c,
-    0xeeea5d5004981478, 0x95527a5202df0ccb,
-    0xbaa718e68396cffd, 0xe950df20247c83fd,
-    0x91d28b7416cdd27e, 0xb6472e511c81471d,
-    0xe3d8f9e563a198e5, 0x8e679c2f5e44ff8f};
-  // A complement to mantissa_64
-  // complete to a 128-bit mantissa.
-  // Uses about 5KB but is rarely accessed.
-  static const uint64_t mantissa_128[] = {
-    0x419ea3bd35385e2d, 0x52064cac828675b9,
-    0x7343efebd1940993, 0x1014ebe6c5f90bf8,
-    0xd41a26e077774ef6, 0x8920b098955522b4,
-    0x55b46e5f5d5535b0, 0xeb2189f734aa831d,
-    0xa5e9ec7501d523e4, 0x47b233c92125366e,
-    0x999ec0bb696e840a, 0xc00670ea43ca250d,
-    0x380406926a5e5728, 0xc605083704f5ecf2,
-    0xf7864a44c633682e, 0x7ab3ee6afbe0211d,
-    0x5960ea05bad82964, 0x6fb92487298e33bd,
-    0xa5d3b6d479f8e056, 0x8f48a4899877186c,
-    0x331acdabfe94de87, 0x9ff0c08b7f1d0b14,
-    0x7ecf0ae5ee44dd9, 0xc9e82cd9f69d6150,
-    0xbe311c083a225cd2, 0x6dbd630a48aaf406,
-    0x92cbbccdad5b108, 0x25bbf56008c58ea5,
-    0xaf2af2b80af6f24e, 0x1af5af660db4aee1,
-    0x50d98d9fc890ed4d, 0xe50ff107bab528a0,
-    0x1e53ed49a96272c8, 0x25e8e89c13bb0f7a,
-    0x77b191618c54e9ac, 0xd59df5b9ef6a2417,
-    0x4b0573286b44ad1d, 0x4ee367f9430aec32,
-    0x229c41f793cda73f, 0x6b43527578c1110f,
-    0x830a13896b78aaa9, 0x23cc986bc656d553,
-    0x2cbfbe86b7ec8aa8, 0x7bf7d71432f3d6a9,
-    0xdaf5ccd93fb0cc53, 0xd1b3400f8f9cff68,
-    0x23100809b9c21fa1, 0xabd40a0c2832a78a,
-    0x16c90c8f323f516c, 0xae3da7d97f6792e3,
-    0x99cd11cfdf41779c, 0x40405643d711d583,
-    0x482835ea666b2572, 0xda3243650005eecf,
-    0x90bed43e40076a82, 0x5a7744a6e804a291,
-    0x711515d0a205cb36, 0xd5a5b44ca873e03,
-    0xe858790afe9486c2, 0x626e974dbe39a872,
-    0xfb0a3d212dc8128f, 0x7ce66634bc9d0b99,
-    0x1c1fffc1ebc44e80, 0xa327ffb266b56220,
-    0x4bf1ff9f0062baa8, 0x6f773fc3603db4a9,
-    0xcb550fb4384d21d3, 0x7e2a53a146606a48,
-    0x2eda7444cbfc426d, 0xfa911155fefb5308,
-    0x793555ab7eba27ca, 0x4bc1558b2f3458de,
-    0x9eb1aaedfb016f16, 0x465e15a979c1cadc,
-    0xbfacd89ec191ec9, 0xcef980ec671f667b,
-    0x82b7e12780e7401a, 0xd1b2ecb8b0908810,
-    0x861fa7e6dcb4aa15, 0x67a791e093e1d49a,
-    0xe0c8bb2c5c6d24e0, 0x58fae9f773886e18,
-    0xaf39a475506a899e, 0x6d8406c952429603,
-    0xc8e5087ba6d33b83, 0xfb1e4a9a90880a64,
-    0x5cf2eea09a55067f, 0xf42faa48c0ea481e,
-    0xf13b94daf124da26, 0x76c53d08d6b70858,
-    0x54768c4b0c64ca6e, 0xa9942f5dcf7dfd09,
-    0xd3f93b35435d7c4c, 0xc47bc5014a1a6daf,
-    0x359ab6419ca1091b, 0xc30163d203c94b62,
-    0x79e0de63425dcf1d, 0x985915fc12f542e4,
-    0x3e6f5b7b17b2939d, 0xa705992ceecf9c42,
-    0x50c6ff782a838353, 0xa4f8bf5635246428,
-    0x871b7795e136be99, 0x28e2557b59846e3f,
-    0x331aeada2fe589cf, 0x3ff0d2c85def7621,
-    0xfed077a756b53a9, 0xd3e8495912c62894,
-    0x64712dd7abbbd95c, 0xbd8d794d96aacfb3,
-    0xecf0d7a0fc5583a0, 0xf41686c49db57244,
-    0x311c2875c522ced5, 0x7d633293366b828b,
-    0xae5dff9c02033197, 0xd9f57f830283fdfc,
-    0xd072df63c324fd7b, 0x4247cb9e59f71e6d,
-    0x52d9be85f074e608, 0x67902e276c921f8b,
-    0xba1cd8a3db53b6, 0x80e8a40eccd228a4,
-    0x6122cd128006b2cd, 0x796b805720085f81,
-    0xcbe3303674053bb0, 0xbedbfc4411068a9c,
-    0xee92fb5515482d44, 0x751bdd152d4d1c4a,
-    0xd262d45a78a0635d, 0x86fb897116c87c34,
-    0xd45d35e6ae3d4da0, 0x8974836059cca109,
-    0x2bd1a438703fc94b, 0x7b6306a34627ddcf,
-    0x1a3bc84c17b1d542, 0x20caba5f1d9e4a93,
-    0x547eb47b7282ee9c, 0xe99e619a4f23aa43,
-    0x6405fa00e2ec94d4, 0xde83bc408dd3dd04,
-    0x9624ab50b148d445, 0x3badd624dd9b0957,
-    0xe54ca5d70a80e5d6, 0x5e9fcf4ccd211f4c,
-    0x7647c3200069671f, 0x29ecd9f40041e073,
-    0xf468107100525890, 0x7182148d4066eeb4,
-    0xc6f14cd848405530, 0xb8ada00e5a506a7c,
-    0xa6d90811f0e4851c, 0x908f4a166d1da663,
-    0x9a598e4e043287fe, 0x40eff1e1853f29fd,
-    0xd12bee59e68ef47c, 0x82bb74f8301958ce,
-    0xe36a52363c1faf01, 0xdc44e6c3cb279ac1,
-    0x29ab103a5ef8c0b9, 0x7415d448f6b6f0e7,
-    0x111b495b3464ad21, 0xcab10dd900beec34,
-    0x3d5d514f40eea742, 0xcb4a5a3112a5112,
-    0x47f0e785eaba72ab, 0x59ed216765690f56,
-    0x306869c13ec3532c, 0x1e414218c73a13fb,
-    0xe5d1929ef90898fa, 0xdf45f746b74abf39,
-    0x6b8bba8c328eb783, 0x66ea92f3f326564,
-    0xc80a537b0efefebd, 0xbd06742ce95f5f36,
-    0x2c48113823b73704, 0xf75a15862ca504c5,
-    0x9a984d73dbe722fb, 0xc13e60d0d2e0ebba,
-    0x318df905079926a8, 0xfdf17746497f7052,
-    0xfeb6ea8bedefa633, 0xfe64a52ee96b8fc0,
-    0x3dfdce7aa3c673b0, 0x6bea10ca65c084e,
-    0x486e494fcff30a62, 0x5a89dba3c3efccfa,
-    0xf89629465a75e01c, 0xf6bbb397f1135823,
-    0x746aa07ded582e2c, 0xa8c2a44eb4571cdc,
-    0x92f34d62616ce413, 0x77b020baf9c81d17,
-    0xace1474dc1d122e, 0xd819992132456ba,
-    0x10e1fff697ed6c69, 0xca8d3ffa1ef463c1,
-    0xbd308ff8a6b17cb2, 0xac7cb3f6d05ddbde,
-    0x6bcdf07a423aa96b, 0x86c16c98d2c953c6,
-    0xe871c7bf077ba8b7, 0x11471cd764ad4972,
-    0xd598e40d3dd89bcf, 0x4aff1d108d4ec2c3,
-    0xcedf722a585139ba, 0xc2974eb4ee658828,
-    0x733d226229feea32, 0x806357d5a3f525f,
-    0xca07c2dcb0cf26f7, 0xfc89b393dd02f0b5,
-    0xbbac2078d443ace2, 0xd54b944b84aa4c0d,
-    0xa9e795e65d4df11, 0x4d4617b5ff4a16d5,
-    0x504bced1bf8e4e45, 0xe45ec2862f71e1d6,
-    0x5d767327bb4e5a4c, 0x3a6a07f8d510f86f,
-    0x890489f70a55368b, 0x2b45ac74ccea842e,
-    0x3b0b8bc90012929d, 0x9ce6ebb40173744,
-    0xcc420a6a101d0515, 0x9fa946824a12232d,
-    0x47939822dc96abf9, 0x59787e2b93bc56f7,
-    0x57eb4edb3c55b65a, 0xede622920b6b23f1,
-    0xe95fab368e45eced, 0x11dbcb0218ebb414,
-    0xd652bdc29f26a119, 0x4be76d3346f0495f,
-    0x6f70a4400c562ddb, 0xcb4ccd500f6bb952,
-    0x7e2000a41346a7a7, 0x8ed400668c0c28c8,
-    0x728900802f0f32fa, 0x4f2b40a03ad2ffb9,
-    0xe2f610c84987bfa8, 0xdd9ca7d2df4d7c9,
-    0x91503d1c79720dbb, 0x75a44c6397ce912a,
-    0xc986afbe3ee11aba, 0xfbe85badce996168,
-    0xfae27299423fb9c3, 0xdccd879fc967d41a,
-    0x5400e987bbc1c920, 0x290123e9aab23b68,
-    0xf9a0b6720aaf6521, 0xf808e40e8d5b3e69,
-    0xb60b1d1230b20e04, 0xb1c6f22b5e6f48c2,
-    0x1e38aeb6360b1af3, 0x25c6da63c38de1b0,
-    0x579c487e5a38ad0e, 0x2d835a9df0c6d851,
-    0xf8e431456cf88e65, 0x1b8e9ecb641b58ff,
-    0xe272467e3d222f3f, 0x5b0ed81dcc6abb0f,
-    0x98e947129fc2b4e9, 0x3f2398d747b36224,
-    0x8eec7f0d19a03aad, 0x1953cf68300424ac,
-    0x5fa8c3423c052dd7, 0x3792f412cb06794d,
-    0xe2bbd88bbee40bd0, 0x5b6aceaeae9d0ec4,
-    0xf245825a5a445275, 0xeed6e2f0f0d56712,
-    0x55464dd69685606b, 0xaa97e14c3c26b886,
-    0xd53dd99f4b3066a8, 0xe546a8038efe4029,
-    0xde98520472bdd033, 0x963e66858f6d4440,
-    0xdde7001379a44aa8, 0x5560c018580d5d52,
-    0xaab8f01e6e10b4a6, 0xcab3961304ca70e8,
-    0x3d607b97c5fd0d22, 0x8cb89a7db77c506a,
-    0x77f3608e92adb242, 0x55f038b237591ed3,
-    0x6b6c46dec52f6688, 0x2323ac4b3b3da015,
-    0xabec975e0a0d081a, 0x96e7bd358c904a21,
-    0x7e50d64177da2e54, 0xdde50bd1d5d0b9e9,
-    0x955e4ec64b44e864, 0xbd5af13bef0b113e,
-    0xecb1ad8aeacdd58e, 0x67de18eda5814af2,
-    0x80eacf948770ced7, 0xa1258379a94d028d,
-    0x96ee45813a04330, 0x8bca9d6e188853fc,
-    0x775ea264cf55347d, 0x95364afe032a819d,
-    0x3a83ddbd83f52204, 0xc4926a9672793542,
-    0x75b7053c0f178293, 0x5324c68b12dd6338,
-    0xd3f6fc16ebca5e03, 0x88f4bb1ca6bcf584,
-    0x2b31e9e3d06c32e5, 0x3aff322e62439fcf,
-    0x9befeb9fad487c2, 0x4c2ebe687989a9b3,
-    0xf9d37014bf60a10, 0x538484c19ef38c94,
-    0x2865a5f206b06fb9, 0xf93f87b7442e45d3,
-    0xf78f69a51539d748, 0xb573440e5a884d1b,
-    0x31680a88f8953030, 0xfdc20d2b36ba7c3d,
-    0x3d32907604691b4c, 0xa63f9a49c2c1b10f,
-    0xfcf80dc33721d53, 0xd3c36113404ea4a8,
-    0x645a1cac083126e9, 0x3d70a3d70a3d70a3,
-    0xcccccccccccccccc, 0x0,
+// The mantissas of powers of ten from -308 to 308, extended out to sixty four
+// bits. The array contains the powers of ten approximated
+// as a 64-bit mantissa. It goes from 10^FASTFLOAT_SMALLEST_POWER to
+// 10^FASTFLOAT_LARGEST_POWER (inclusively).
+// The mantissa is truncated, and
+// never rounded up. Uses about 5KB.
+template <typename unused>
+const uint64_t powers_template<unused>::mantissa_64[] = {
+    0xeef453d6923bd65a, 0x9558b4661b6565f8,
+    0xbaaee17fa23ebf76, 0xe95a99df8ace6f53,
+    0x91d8a02bb6c10594, 0xb64ec836a47146f9,
+    0xe3e27a444d8d98b7, 0x8e6d8c6ab0787f72,
+    0xb208ef855c969f4f, 0xde8b2b66b3bc4723,
+    0x8b16fb203055ac76, 0xaddcb9e83c6b1793,
+    0xd953e8624b85dd78, 0x87d4713d6f33aa6b,
+    0xa9c98d8ccb009506, 0xd43bf0effdc0ba48,
+    0x84a57695fe98746d, 0xa5ced43b7e3e9188,
+    0xcf42894a5dce35ea, 0x818995ce7aa0e1b2,
+    0xa1ebfb4219491a1f, 0xca66fa129f9b60a6,
+    0xfd00b897478238d0, 0x9e20735e8cb16382,
+    0xc5a890362fddbc62, 0xf712b443bbd52b7b,
+    0x9a6bb0aa55653b2d, 0xc1069cd4eabe89f8,
+    0xf148440a256e2c76, 0x96cd2a865764dbca,
+    0xbc807527ed3e12bc, 0xeba09271e88d976b,
+    0x93445b8731587ea3, 0xb8157268fdae9e4c,
+    0xe61acf033d1a45df, 0x8fd0c16206306bab,
+    0xb3c4f1ba87bc8696, 0xe0b62e2929aba83c,
+    0x8c71dcd9ba0b4925, 0xaf8e5410288e1b6f,
+    0xdb71e91432b1a24a, 0x892731ac9faf056e,
+    0xab70fe17c79ac6ca, 0xd64d3d9db981787d,
+    0x85f0468293f0eb4e, 0xa76c582338ed2621,
+    0xd1476e2c07286faa, 0x82cca4db847945ca,
+    0xa37fce126597973c, 0xcc5fc196fefd7d0c,
+    0xff77b1fcbebcdc4f, 0x9faacf3df73609b1,
+    0xc795830d75038c1d, 0xf97ae3d0d2446f25,
+    0x9becce62836ac577, 0xc2e801fb244576d5,
+    0xf3a20279ed56d48a, 0x9845418c345644d6,
+    0xbe5691ef416bd60c, 0xedec366b11c6cb8f,
+    0x94b3a202eb1c3f39, 0xb9e08a83a5e34f07,
+    0xe858ad248f5c22c9, 0x91376c36d99995be,
+    0xb58547448ffffb2d, 0xe2e69915b3fff9f9,
+    0x8dd01fad907ffc3b, 0xb1442798f49ffb4a,
+    0xdd95317f31c7fa1d, 0x8a7d3eef7f1cfc52,
+    0xad1c8eab5ee43b66, 0xd863b256369d4a40,
+    0x873e4f75e2224e68, 0xa90de3535aaae202,
+    0xd3515c2831559a83, 0x8412d9991ed58091,
+    0xa5178fff668ae0b6, 0xce5d73ff402d98e3,
+    0x80fa687f881c7f8e, 0xa139029f6a239f72,
+    0xc987434744ac874e, 0xfbe9141915d7a922,
+    0x9d71ac8fada6c9b5, 0xc4ce17b399107c22,
+    0xf6019da07f549b2b, 0x99c102844f94e0fb,
+    0xc0314325637a1939, 0xf03d93eebc589f88,
+    0x96267c7535b763b5, 0xbbb01b9283253ca2,
+    0xea9c227723ee8bcb, 0x92a1958a7675175f,
+    0xb749faed14125d36, 0xe51c79a85916f484,
+    0x8f31cc0937ae58d2, 0xb2fe3f0b8599ef07,
+    0xdfbdcece67006ac9, 0x8bd6a141006042bd,
+    0xaecc49914078536d, 0xda7f5bf590966848,
+    0x888f99797a5e012d, 0xaab37fd7d8f58178,
+    0xd5605fcdcf32e1d6, 0x855c3be0a17fcd26,
+    0xa6b34ad8c9dfc06f, 0xd0601d8efc57b08b,
+    0x823c12795db6ce57, 0xa2cb1717b52481ed,
+    0xcb7ddcdda26da268, 0xfe5d54150b090b02,
+    0x9efa548d26e5a6e1, 0xc6b8e9b0709f109a,
+    0xf867241c8cc6d4c0, 0x9b407691d7fc44f8,
+    0xc21094364dfb5636, 0xf294b943e17a2bc4,
+    0x979cf3ca6cec5b5a, 0xbd8430bd08277231,
+    0xece53cec4a314ebd, 0x940f4613ae5ed136,
+    0xb913179899f68584, 0xe757dd7ec07426e5,
+    0x9096ea6f3848984f, 0xb4bca50b065abe63,
+    0xe1ebce4dc7f16dfb, 0x8d3360f09cf6e4bd,
+    0xb080392cc4349dec, 0xdca04777f541c567,
+    0x89e42caaf9491b60, 0xac5d37d5b79b6239,
+    0xd77485cb25823ac7, 0x86a8d39ef77164bc,
+    0xa8530886b54dbdeb, 0xd267caa862a12d66,
+    0x8380dea93da4bc60, 0xa46116538d0deb78,
+    0xcd795be870516656, 0x806bd9714632dff6,
+    0xa086cfcd97bf97f3, 0xc8a883c0fdaf7df0,
+    0xfad2a4b13d1b5d6c, 0x9cc3a6eec6311a63,
+    0xc3f490aa77bd60fc, 0xf4f1b4d515acb93b,
+    0x991711052d8bf3c5, 0xbf5cd54678eef0b6,
+    0xef340a98172aace4, 0x9580869f0e7aac0e,
+    0xbae0a846d2195712, 0xe998d258869facd7,
+    0x91ff83775423cc06, 0xb67f6455292cbf08,
+    0xe41f3d6a7377eeca, 0x8e938662882af53e,
+    0xb23867fb2a35b28d, 0xdec681f9f4c31f31,
+    0x8b3c113c38f9f37e, 0xae0b158b4738705e,
+    0xd98ddaee19068c76, 0x87f8a8d4cfa417c9,
+    0xa9f6d30a038d1dbc, 0xd47487cc8470652b,
+    0x84c8d4dfd2c63f3b, 0xa5fb0a17c777cf09,
+    0xcf79cc9db955c2cc, 0x81ac1fe293d599bf,
+    0xa21727db38cb002f, 0xca9cf1d206fdc03b,
+    0xfd442e4688bd304a, 0x9e4a9cec15763e2e,
+    0xc5dd44271ad3cdba, 0xf7549530e188c128,
+    0x9a94dd3e8cf578b9, 0xc13a148e3032d6e7,
+    0xf18899b1bc3f8ca1, 0x96f5600f15a7b7e5,
+    0xbcb2b812db11a5de, 0xebdf661791d60f56,
+    0x936b9fcebb25c995, 0xb84687c269ef3bfb,
+    0xe65829b3046b0afa, 0x8ff71a0fe2c2e6dc,
+    0xb3f4e093db73a093, 0xe0f218b8d25088b8,
+    0x8c974f7383725573, 0xafbd2350644eeacf,
+    0xdbac6c247d62a583, 0x894bc396ce5da772,
+    0xab9eb47c81f5114f, 0xd686619ba27255a2,
+    0x8613fd0145877585, 0xa798fc4196e952e7,
+    0xd17f3b51fca3a7a0, 0x82ef85133de648c4,
+    0xa3ab66580d5fdaf5, 0xcc963fee10b7d1b3,
+    0xffbbcfe994e5c61f, 0x9fd561f1fd0f9bd3,
+    0xc7caba6e7c5382c8, 0xf9bd690a1b68637b,
+    0x9c1661a651213e2d, 0xc31bfa0fe5698db8,
+    0xf3e2f893dec3f126, 0x986ddb5c6b3a76b7,
+    0xbe89523386091465, 0xee2ba6c0678b597f,
+    0x94db483840b717ef, 0xba121a4650e4ddeb,
+    0xe896a0d7e51e1566, 0x915e2486ef32cd60,
+    0xb5b5ada8aaff80b8, 0xe3231912d5bf60e6,
+    0x8df5efabc5979c8f, 0xb1736b96b6fd83b3,
+    0xddd0467c64bce4a0, 0x8aa22c0dbef60ee4,
+    0xad4ab7112eb3929d, 0xd89d64d57a607744,
+    0x87625f056c7c4a8b, 0xa93af6c6c79b5d2d,
+    0xd389b47879823479, 0x843610cb4bf160cb,
+    0xa54394fe1eedb8fe, 0xce947a3da6a9273e,
+    0x811ccc668829b887, 0xa163ff802a3426a8,
+    0xc9bcff6034c13052, 0xfc2c3f3841f17c67,
+    0x9d9ba7832936edc0, 0xc5029163f384a931,
+    0xf64335bcf065d37d, 0x99ea0196163fa42e,
+    0xc06481fb9bcf8d39, 0xf07da27a82c37088,
+    0x964e858c91ba2655, 0xbbe226efb628afea,
+    0xeadab0aba3b2dbe5, 0x92c8ae6b464fc96f,
+    0xb77ada0617e3bbcb, 0xe55990879ddcaabd,
+    0x8f57fa54c2a9eab6, 0xb32df8e9f3546564,
+    0xdff9772470297ebd, 0x8bfbea76c619ef36,
+    0xaefae51477a06b03, 0xdab99e59958885c4,
+    0x88b402f7fd75539b, 0xaae103b5fcd2a881,
+    0xd59944a37c0752a2, 0x857fcae62d8493a5,
+    0xa6dfbd9fb8e5b88e, 0xd097ad07a71f26b2,
+    0x825ecc24c873782f, 0xa2f67f2dfa90563b,
+    0xcbb41ef979346bca, 0xfea126b7d78186bc,
+    0x9f24b832e6b0f436, 0xc6ede63fa05d3143,
+    0xf8a95fcf88747d94, 0x9b69dbe1b548ce7c,
+    0xc24452da229b021b, 0xf2d56790ab41c2a2,
+    0x97c560ba6b0919a5, 0xbdb6b8e905cb600f,
+    0xed246723473e3813, 0x9436c0760c86e30b,
+    0xb94470938fa89bce, 0xe7958cb87392c2c2,
+    0x90bd77f3483bb9b9, 0xb4ecd5f01a4aa828,
+    0xe2280b6c20dd5232, 0x8d590723948a535f,
+    0xb0af48ec79ace837, 0xdcdb1b2798182244,
+    0x8a08f0f8bf0f156b, 0xac8b2d36eed2dac5,
+    0xd7adf884aa879177, 0x86ccbb52ea94baea,
+    0xa87fea27a539e9a5, 0xd29fe4b18e88640e,
+    0x83a3eeeef9153e89, 0xa48ceaaab75a8e2b,
+    0xcdb02555653131b6, 0x808e17555f3ebf11,
+    0xa0b19d2ab70e6ed6, 0xc8de047564d20a8b,
+    0xfb158592be068d2e, 0x9ced737bb6c4183d,
+    0xc428d05aa4751e4c, 0xf53304714d9265df,
+    0x993fe2c6d07b7fab, 0xbf8fdb78849a5f96,
+    0xef73d256a5c0f77c, 0x95a8637627989aad,
+    0xbb127c53b17ec159, 0xe9d71b689dde71af,
+    0x9226712162ab070d, 0xb6b00d69bb55c8d1,
+    0xe45c10c42a2b3b05, 0x8eb98a7a9a5b04e3,
+    0xb267ed1940f1c61c, 0xdf01e85f912e37a3,
+    0x8b61313bbabce2c6, 0xae397d8aa96c1b77,
+    0xd9c7dced53c72255, 0x881cea14545c7575,
+    0xaa242499697392d2, 0xd4ad2dbfc3d07787,
+    0x84ec3c97da624ab4, 0xa6274bbdd0fadd61,
+    0xcfb11ead453994ba, 0x81ceb32c4b43fcf4,
+    0xa2425ff75e14fc31, 0xcad2f7f5359a3b3e,
+    0xfd87b5f28300ca0d, 0x9e74d1b791e07e48,
+    0xc612062576589dda, 0xf79687aed3eec551,
+    0x9abe14cd44753b52, 0xc16d9a0095928a27,
+    0xf1c90080baf72cb1, 0x971da05074da7bee,
+    0xbce5086492111aea, 0xec1e4a7db69561a5,
+    0x9392ee8e921d5d07, 0xb877aa3236a4b449,
+    0xe69594bec44de15b, 0x901d7cf73ab0acd9,
+    0xb424dc35095cd80f, 0xe12e13424bb40e13,
+    0x8cbccc096f5088cb, 0xafebff0bcb24aafe,
+    0xdbe6fecebdedd5be, 0x89705f4136b4a597,
+    0xabcc77118461cefc, 0xd6bf94d5e57a42bc,
+    0x8637bd05af6c69b5, 0xa7c5ac471b478423,
+    0xd1b71758e219652b, 0x83126e978d4fdf3b,
+    0xa3d70a3d70a3d70a, 0xcccccccccccccccc,
+    0x8000000000000000, 0xa000000000000000,
+    0xc800000000000000, 0xfa00000000000000,
+    0x9c40000000000000, 0xc350000000000000,
+    0xf424000000000000, 0x9896800000000000,
+    0xbebc200000000000, 0xee6b280000000000,
+    0x9502f90000000000, 0xba43b74000000000,
+    0xe8d4a51000000000, 0x9184e72a00000000,
+    0xb5e620f480000000, 0xe35fa931a0000000,
+    0x8e1bc9bf04000000, 0xb1a2bc2ec5000000,
+    0xde0b6b3a76400000, 0x8ac7230489e80000,
+    0xad78ebc5ac620000, 0xd8d726b7177a8000,
+    0x878678326eac9000, 0xa968163f0a57b400,
+    0xd3c21bcecceda100, 0x84595161401484a0,
+    0xa56fa5b99019a5c8, 0xcecb8f27f4200f3a,
+    0x813f3978f8940984, 0xa18f07d736b90be5,
+    0xc9f2c9cd04674ede, 0xfc6f7c4045812296,
+    0x9dc5ada82b70b59d, 0xc5371912364ce305,
+    0xf684df56c3e01bc6, 0x9a130b963a6c115c,
+    0xc097ce7bc90715b3, 0xf0bdc21abb48db20,
+    0x96769950b50d88f4, 0xbc143fa4e250eb31,
+    0xeb194f8e1ae525fd, 0x92efd1b8d0cf37be,
+    0xb7abc627050305ad, 0xe596b7b0c643c719,
+    0x8f7e32ce7bea5c6f, 0xb35dbf821ae4f38b,
+    0xe0352f62a19e306e, 0x8c213d9da502de45,
+    0xaf298d050e4395d6, 0xdaf3f04651d47b4c,
+    0x88d8762bf324cd0f, 0xab0e93b6efee0053,
+    0xd5d238a4abe98068, 0x85a36366eb71f041,
+    0xa70c3c40a64e6c51, 0xd0cf4b50cfe20765,
+    0x82818f1281ed449f, 0xa321f2d7226895c7,
+    0xcbea6f8ceb02bb39, 0xfee50b7025c36a08,
+    0x9f4f2726179a2245, 0xc722f0ef9d80aad6,
+    0xf8ebad2b84e0d58b, 0x9b934c3b330c8577,
+    0xc2781f49ffcfa6d5, 0xf316271c7fc3908a,
+    0x97edd871cfda3a56, 0xbde94e8e43d0c8ec,
+    0xed63a231d4c4fb27, 0x945e455f24fb1cf8,
+    0xb975d6b6ee39e436, 0xe7d34c64a9c85d44,
+    0x90e40fbeea1d3a4a, 0xb51d13aea4a488dd,
+    0xe264589a4dcdab14, 0x8d7eb76070a08aec,
+    0xb0de65388cc8ada8, 0xdd15fe86affad912,
+    0x8a2dbf142dfcc7ab, 0xacb92ed9397bf996,
+    0xd7e77a8f87daf7fb, 0x86f0ac99b4e8dafd,
+    0xa8acd7c0222311bc, 0xd2d80db02aabd62b,
+    0x83c7088e1aab65db, 0xa4b8cab1a1563f52,
+    0xcde6fd5e09abcf26, 0x80b05e5ac60b6178,
+    0xa0dc75f1778e39d6, 0xc913936dd571c84c,
+    0xfb5878494ace3a5f, 0x9d174b2dcec0e47b,
+    0xc45d1df942711d9a, 0xf5746577930d6500,
+    0x9968bf6abbe85f20, 0xbfc2ef456ae276e8,
+    0xefb3ab16c59b14a2, 0x95d04aee3b80ece5,
+    0xbb445da9ca61281f, 0xea1575143cf97226,
+    0x924d692ca61be758, 0xb6e0c377cfa2e12e,
+    0xe498f455c38b997a, 0x8edf98b59a373fec,
+    0xb2977ee300c50fe7, 0xdf3d5e9bc0f653e1,
+    0x8b865b215899f46c, 0xae67f1e9aec07187,
+    0xda01ee641a708de9, 0x884134fe908658b2,
+    0xaa51823e34a7eede, 0xd4e5e2cdc1d1ea96,
+    0x850fadc09923329e, 0xa6539930bf6bff45,
+    0xcfe87f7cef46ff16, 0x81f14fae158c5f6e,
+    0xa26da3999aef7749, 0xcb090c8001ab551c,
+    0xfdcb4fa002162a63, 0x9e9f11c4014dda7e,
+    0xc646d63501a1511d, 0xf7d88bc24209a565,
+    0x9ae757596946075f, 0xc1a12d2fc3978937,
+    0xf209787bb47d6b84, 0x9745eb4d50ce6332,
+    0xbd176620a501fbff, 0xec5d3fa8ce427aff,
+    0x93ba47c980e98cdf, 0xb8a8d9bbe123f017,
+    0xe6d3102ad96cec1d, 0x9043ea1ac7e41392,
+    0xb454e4a179dd1877, 0xe16a1dc9d8545e94,
+    0x8ce2529e2734bb1d, 0xb01ae745b101e9e4,
+    0xdc21a1171d42645d, 0x899504ae72497eba,
+    0xabfa45da0edbde69, 0xd6f8d7509292d603,
+    0x865b86925b9bc5c2, 0xa7f26836f282b732,
+    0xd1ef0244af2364ff, 0x8335616aed761f1f,
+    0xa402b9c5a8d3a6e7, 0xcd036837130890a1,
+    0x802221226be55a64, 0xa02aa96b06deb0fd,
+    0xc83553c5c8965d3d, 0xfa42a8b73abbf48c,
+    0x9c69a97284b578d7, 0xc38413cf25e2d70d,
+    0xf46518c2ef5b8cd1, 0x98bf2f79d5993802,
+    0xbeeefb584aff8603, 0xeeaaba2e5dbf6784,
+    0x952ab45cfa97a0b2, 0xba756174393d88df,
+    0xe912b9d1478ceb17, 0x91abb422ccb812ee,
+    0xb616a12b7fe617aa, 0xe39c49765fdf9d94,
+    0x8e41ade9fbebc27d, 0xb1d219647ae6b31c,
+    0xde469fbd99a05fe3, 0x8aec23d680043bee,
+    0xada72ccc20054ae9, 0xd910f7ff28069da4,
+    0x87aa9aff79042286, 0xa99541bf57452b28,
+    0xd3fa922f2d1675f2, 0x847c9b5d7c2e09b7,
+    0xa59bc234db398c25, 0xcf02b2c21207ef2e,
+    0x8161afb94b44f57d, 0xa1ba1ba79e1632dc,
+    0xca28a291859bbf93, 0xfcb2cb35e702af78,
+    0x9defbf01b061adab, 0xc56baec21c7a1916,
+    0xf6c69a72a3989f5b, 0x9a3c2087a63f6399,
+    0xc0cb28a98fcf3c7f, 0xf0fdf2d3f3c30b9f,
+    0x969eb7c47859e743, 0xbc4665b596706114,
+    0xeb57ff22fc0c7959, 0x9316ff75dd87cbd8,
+    0xb7dcbf5354e9bece, 0xe5d3ef282a242e81,
+    0x8fa475791a569d10, 0xb38d92d760ec4455,
+    0xe070f78d3927556a, 0x8c469ab843b89562,
+    0xaf58416654a6babb, 0xdb2e51bfe9d0696a,
+    0x88fcf317f22241e2, 0xab3c2fddeeaad25a,
+    0xd60b3bd56a5586f1, 0x85c7056562757456,
+    0xa738c6bebb12d16c, 0xd106f86e69d785c7,
+    0x82a45b450226b39c, 0xa34d721642b06084,
+    0xcc20ce9bd35c78a5, 0xff290242c83396ce,
+    0x9f79a169bd203e41, 0xc75809c42c684dd1,
+    0xf92e0c3537826145, 0x9bbcc7a142b17ccb,
+    0xc2abf989935ddbfe, 0xf356f7ebf83552fe,
+    0x98165af37b2153de, 0xbe1bf1b059e9a8d6,
+    0xeda2ee1c7064130c, 0x9485d4d1c63e8be7,
+    0xb9a74a0637ce2ee1, 0xe8111c87c5c1ba99,
+    0x910ab1d4db9914a0, 0xb54d5e4a127f59c8,
+    0xe2a0b5dc971f303a, 0x8da471a9de737e24,
+    0xb10d8e1456105dad, 0xdd50f1996b947518,
+    0x8a5296ffe33cc92f, 0xace73cbfdc0bfb7b,
+    0xd8210befd30efa5a, 0x8714a775e3e95c78,
+    0xa8d9d1535ce3b396, 0xd31045a8341ca07c,
+    0x83ea2b892091e44d, 0xa4e4b66b68b65d60,
+    0xce1de40642e3f4b9, 0x80d2ae83e9ce78f3,
+    0xa1075a24e4421730, 0xc94930ae1d529cfc,
+    0xfb9b7cd9a4a7443c, 0x9d412e0806e88aa5,
+    0xc491798a08a2ad4e, 0xf5b5d7ec8acb58a2,
+    0x9991a6f3d6bf1765, 0xbff610b0cc6edd3f,
+    0xeff394dcff8a948e, 0x95f83d0a1fb69cd9,
+    0xbb764c4ca7a4440f, 0xea53df5fd18d5513,
+    0x92746b9be2f8552c, 0xb7118682dbb66a77,
+    0xe4d5e82392a40515, 0x8f05b1163ba6832d,
+    0xb2c71d5bca9023f8, 0xdf78e4b2bd342cf6,
+    0x8bab8eefb6409c1a, 0xae9672aba3d0c320,
+    0xda3c0f568cc4f3e8, 0x8865899617fb1871,
+    0xaa7eebfb9df9de8d, 0xd51ea6fa85785631,
+    0x8533285c936b35de, 0xa67ff273b8460356,
+    0xd01fef10a657842c, 0x8213f56a67f6b29b,
+    0xa298f2c501f45f42, 0xcb3f2f7642717713,
+    0xfe0efb53d30dd4d7, 0x9ec95d1463e8a506,
+    0xc67bb4597ce2ce48, 0xf81aa16fdc1b81da,
+    0x9b10a4e5e9913128, 0xc1d4ce1f63f57d72,
+    0xf24a01a73cf2dccf, 0x976e41088617ca01,
+    0xbd49d14aa79dbc82, 0xec9c459d51852ba2,
+    0x93e1ab8252f33b45, 0xb8da1662e7b00a17,
+    0xe7109bfba19c0c9d, 0x906a617d450187e2,
+    0xb484f9dc9641e9da, 0xe1a63853bbd26451,
+    0x8d07e33455637eb2, 0xb049dc016abc5e5f,
+    0xdc5c5301c56b75f7, 0x89b9b3e11b6329ba,
+    0xac2820d9623bf429, 0xd732290fbacaf133,
+    0x867f59a9d4bed6c0, 0xa81f301449ee8c70,
+    0xd226fc195c6a2f8c, 0x83585d8fd9c25db7,
+    0xa42e74f3d032f525, 0xcd3a1230c43fb26f,
+    0x80444b5e7aa7cf85, 0xa0555e361951c366,
+    0xc86ab5c39fa63440, 0xfa856334878fc150,
+    0x9c935e00d4b9d8d2, 0xc3b8358109e84f07,
+    0xf4a642e14c6262c8, 0x98e7e9cccfbd7dbd,
+    0xbf21e44003acdd2c, 0xeeea5d5004981478,
+    0x95527a5202df0ccb, 0xbaa718e68396cffd,
+    0xe950df20247c83fd, 0x91d28b7416cdd27e,
+    0xb6472e511c81471d, 0xe3d8f9e563a198e5,
+    0x8e679c2f5e44ff8f};
+// A complement to mantissa_64
+// complete to a 128-bit mantissa.
+// Uses about 5KB but is rarely accessed.
+template <typename unused>
+const uint64_t powers_template<unused>::mantissa_128[] = {
+    0x113faa2906a13b3f, 0x4ac7ca59a424c507,
+    0x5d79bcf00d2df649, 0xf4d82c2c107973dc,
+    0x79071b9b8a4be869, 0x9748e2826cdee284,
+    0xfd1b1b2308169b25, 0xfe30f0f5e50e20f7,
+    0xbdbd2d335e51a935, 0xad2c788035e61382,
+    0x4c3bcb5021afcc31, 0xdf4abe242a1bbf3d,
+    0xd71d6dad34a2af0d, 0x8672648c40e5ad68,
+    0x680efdaf511f18c2, 0x0212bd1b2566def2,
+    0x014bb630f7604b57, 0x419ea3bd35385e2d,
+    0x52064cac828675b9, 0x7343efebd1940993,
+    0x1014ebe6c5f90bf8, 0xd41a26e077774ef6,
+    0x8920b098955522b4, 0x55b46e5f5d5535b0,
+    0xeb2189f734aa831d, 0xa5e9ec7501d523e4,
+    0x47b233c92125366e, 0x999ec0bb696e840a,
+    0xc00670ea43ca250d, 0x380406926a5e5728,
+    0xc605083704f5ecf2, 0xf7864a44c633682e,
+    0x7ab3ee6afbe0211d, 0x5960ea05bad82964,
+    0x6fb92487298e33bd, 0xa5d3b6d479f8e056,
+    0x8f48a4899877186c, 0x331acdabfe94de87,
+    0x9ff0c08b7f1d0b14, 0x7ecf0ae5ee44dd9,
+    0xc9e82cd9f69d6150, 0xbe311c083a225cd2,
+    0x6dbd630a48aaf406, 0x92cbbccdad5b108,
+    0x25bbf56008c58ea5, 0xaf2af2b80af6f24e,
+    0x1af5af660db4aee1, 0x50d98d9fc890ed4d,
+    0xe50ff107bab528a0, 0x1e53ed49a96272c8,
+    0x25e8e89c13bb0f7a, 0x77b191618c54e9ac,
+    0xd59df5b9ef6a2417, 0x4b0573286b44ad1d,
+    0x4ee367f9430aec32, 0x229c41f793cda73f,
+    0x6b43527578c1110f, 0x830a13896b78aaa9,
+    0x23cc986bc656d553, 0x2cbfbe86b7ec8aa8,
+    0x7bf7d71432f3d6a9, 0xdaf5ccd93fb0cc53,
+    0xd1b3400f8f9cff68, 0x23100809b9c21fa1,
+    0xabd40a0c2832a78a, 0x16c90c8f323f516c,
+    0xae3da7d97f6792e3, 0x99cd11cfdf41779c,
+    0x40405643d711d583, 0x482835ea666b2572,
+    0xda3243650005eecf, 0x90bed43e40076a82,
+    0x5a7744a6e804a291, 0x711515d0a205cb36,
+    0xd5a5b44ca873e03, 0xe858790afe9486c2,
+    0x626e974dbe39a872, 0xfb0a3d212dc8128f,
+    0x7ce66634bc9d0b99, 0x1c1fffc1ebc44e80,
+    0xa327ffb266b56220, 0x4bf1ff9f0062baa8,
+    0x6f773fc3603db4a9, 0xcb550fb4384d21d3,
+    0x7e2a53a146606a48, 0x2eda7444cbfc426d,
+    0xfa911155fefb5308, 0x793555ab7eba27ca,
+    0x4bc1558b2f3458de, 0x9eb1aaedfb016f16,
+    0x465e15a979c1cadc, 0xbfacd89ec191ec9,
+    0xcef980ec671f667b, 0x82b7e12780e7401a,
+    0xd1b2ecb8b0908810, 0x861fa7e6dcb4aa15,
+    0x67a791e093e1d49a, 0xe0c8bb2c5c6d24e0,
+    0x58fae9f773886e18, 0xaf39a475506a899e,
+    0x6d8406c952429603, 0xc8e5087ba6d33b83,
+    0xfb1e4a9a90880a64, 0x5cf2eea09a55067f,
+    0xf42faa48c0ea481e, 0xf13b94daf124da26,
+    0x76c53d08d6b70858, 0x54768c4b0c64ca6e,
+    0xa9942f5dcf7dfd09, 0xd3f93b35435d7c4c,
+    0xc47bc5014a1a6daf, 0x359ab6419ca1091b,
+    0xc30163d203c94b62, 0x79e0de63425dcf1d,
+    0x985915fc12f542e4, 0x3e6f5b7b17b2939d,
+    0xa705992ceecf9c42, 0x50c6ff782a838353,
+    0xa4f8bf5635246428, 0x871b7795e136be99,
+    0x28e2557b59846e3f, 0x331aeada2fe589cf,
+    0x3ff0d2c85def7621, 0xfed077a756b53a9,
+    0xd3e8495912c62894, 0x64712dd7abbbd95c,
+    0xbd8d794d96aacfb3, 0xecf0d7a0fc5583a0,
+    0xf41686c49db57244, 0x311c2875c522ced5,
+    0x7d633293366b828b, 0xae5dff9c02033197,
+    0xd9f57f830283fdfc, 0xd072df63c324fd7b,
+    0x4247cb9e59f71e6d, 0x52d9be85f074e608,
+    0x67902e276c921f8b, 0xba1cd8a3db53b6,
+    0x80e8a40eccd228a4, 0x6122cd128006b2cd,
+    0x796b805720085f81, 0xcbe3303674053bb0,
+    0xbedbfc4411068a9c, 0xee92fb5515482d44,
+    0x751bdd152d4d1c4a, 0xd262d45a78a0635d,
+    0x86fb897116c87c34, 0xd45d35e6ae3d4da0,
+    0x8974836059cca109, 0x2bd1a438703fc94b,
+    0x7b6306a34627ddcf, 0x1a3bc84c17b1d542,
+    0x20caba5f1d9e4a93, 0x547eb47b7282ee9c,
+    0xe99e619a4f23aa43, 0x6405fa00e2ec94d4,
+    0xde83bc408dd3dd04, 0x9624ab50b148d445,
+    0x3badd624dd9b0957, 0xe54ca5d70a80e5d6,
+    0x5e9fcf4ccd211f4c, 0x7647c3200069671f,
+    0x29ecd9f40041e073, 0xf468107100525890,
+    0x7182148d4066eeb4, 0xc6f14cd848405530,
+    0xb8ada00e5a506a7c, 0xa6d90811f0e4851c,
+    0x908f4a166d1da663, 0x9a598e4e043287fe,
+    0x40eff1e1853f29fd, 0xd12bee59e68ef47c,
+    0x82bb74f8301958ce, 0xe36a52363c1faf01,
+    0xdc44e6c3cb279ac1, 0x29ab103a5ef8c0b9,
+    0x7415d448f6b6f0e7, 0x111b495b3464ad21,
+    0xcab10dd900beec34, 0x3d5d514f40eea742,
+    0xcb4a5a3112a5112, 0x47f0e785eaba72ab,
+    0x59ed216765690f56, 0x306869c13ec3532c,
+    0x1e414218c73a13fb, 0xe5d1929ef90898fa,
+    0xdf45f746b74abf39, 0x6b8bba8c328eb783,
+    0x66ea92f3f326564, 0xc80a537b0efefebd,
+    0xbd06742ce95f5f36, 0x2c48113823b73704,
+    0xf75a15862ca504c5, 0x9a984d73dbe722fb,
+    0xc13e60d0d2e0ebba, 0x318df905079926a8,
+    0xfdf17746497f7052, 0xfeb6ea8bedefa633,
+    0xfe64a52ee96b8fc0, 0x3dfdce7aa3c673b0,
+    0x6bea10ca65c084e, 0x486e494fcff30a62,
+    0x5a89dba3c3efccfa, 0xf89629465a75e01c,
+    0xf6bbb397f1135823, 0x746aa07ded582e2c,
+    0xa8c2a44eb4571cdc, 0x92f34d62616ce413,
+    0x77b020baf9c81d17, 0xace1474dc1d122e,
+    0xd819992132456ba, 0x10e1fff697ed6c69,
+    0xca8d3ffa1ef463c1, 0xbd308ff8a6b17cb2,
+    0xac7cb3f6d05ddbde, 0x6bcdf07a423aa96b,
+    0x86c16c98d2c953c6, 0xe871c7bf077ba8b7,
+    0x11471cd764ad4972, 0xd598e40d3dd89bcf,
+    0x4aff1d108d4ec2c3, 0xcedf722a585139ba,
+    0xc2974eb4ee658828, 0x733d226229feea32,
+    0x806357d5a3f525f, 0xca07c2dcb0cf26f7,
+    0xfc89b393dd02f0b5, 0xbbac2078d443ace2,
+    0xd54b944b84aa4c0d, 0xa9e795e65d4df11,
+    0x4d4617b5ff4a16d5, 0x504bced1bf8e4e45,
+    0xe45ec2862f71e1d6, 0x5d767327bb4e5a4c,
+    0x3a6a07f8d510f86f, 0x890489f70a55368b,
+    0x2b45ac74ccea842e, 0x3b0b8bc90012929d,
+    0x9ce6ebb40173744, 0xcc420a6a101d0515,
+    0x9fa946824a12232d, 0x47939822dc96abf9,
+    0x59787e2b93bc56f7, 0x57eb4edb3c55b65a,
+    0xede622920b6b23f1, 0xe95fab368e45eced,
+    0x11dbcb0218ebb414, 0xd652bdc29f26a119,
+    0x4be76d3346f0495f, 0x6f70a4400c562ddb,
+    0xcb4ccd500f6bb952, 0x7e2000a41346a7a7,
+    0x8ed400668c0c28c8, 0x728900802f0f32fa,
+    0x4f2b40a03ad2ffb9, 0xe2f610c84987bfa8,
+    0xdd9ca7d2df4d7c9, 0x91503d1c79720dbb,
+    0x75a44c6397ce912a, 0xc986afbe3ee11aba,
+    0xfbe85badce996168, 0xfae27299423fb9c3,
+    0xdccd879fc967d41a, 0x5400e987bbc1c920,
+    0x290123e9aab23b68, 0xf9a0b6720aaf6521,
+    0xf808e40e8d5b3e69, 0xb60b1d1230b20e04,
+    0xb1c6f22b5e6f48c2, 0x1e38aeb6360b1af3,
+    0x25c6da63c38de1b0, 0x579c487e5a38ad0e,
+    0x2d835a9df0c6d851, 0xf8e431456cf88e65,
+    0x1b8e9ecb641b58ff, 0xe272467e3d222f3f,
+    0x5b0ed81dcc6abb0f, 0x98e947129fc2b4e9,
+    0x3f2398d747b36224, 0x8eec7f0d19a03aad,
+    0x1953cf68300424ac, 0x5fa8c3423c052dd7,
+    0x3792f412cb06794d, 0xe2bbd88bbee40bd0,
+    0x5b6aceaeae9d0ec4, 0xf245825a5a445275,
+    0xeed6e2f0f0d56712, 0x55464dd69685606b,
+    0xaa97e14c3c26b886, 0xd53dd99f4b3066a8,
+    0xe546a8038efe4029, 0xde98520472bdd033,
+    0x963e66858f6d4440, 0xdde7001379a44aa8,
+    0x5560c018580d5d52, 0xaab8f01e6e10b4a6,
+    0xcab3961304ca70e8, 0x3d607b97c5fd0d22,
+    0x8cb89a7db77c506a, 0x77f3608e92adb242,
+    0x55f038b237591ed3, 0x6b6c46dec52f6688,
+    0x2323ac4b3b3da015, 0xabec975e0a0d081a,
+    0x96e7bd358c904a21, 0x7e50d64177da2e54,
+    0xdde50bd1d5d0b9e9, 0x955e4ec64b44e864,
+    0xbd5af13bef0b113e, 0xecb1ad8aeacdd58e,
+    0x67de18eda5814af2, 0x80eacf948770ced7,
+    0xa1258379a94d028d, 0x96ee45813a04330,
+    0x8bca9d6e188853fc, 0x775ea264cf55347d,
+    0x95364afe032a819d, 0x3a83ddbd83f52204,
+    0xc4926a9672793542, 0x75b7053c0f178293,
+    0x5324c68b12dd6338, 0xd3f6fc16ebca5e03,
+    0x88f4bb1ca6bcf584, 0x2b31e9e3d06c32e5,
+    0x3aff322e62439fcf, 0x9befeb9fad487c2,
+    0x4c2ebe687989a9b3, 0xf9d37014bf60a10,
+    0x538484c19ef38c94, 0x2865a5f206b06fb9,
+    0xf93f87b7442e45d3, 0xf78f69a51539d748,
+    0xb573440e5a884d1b, 0x31680a88f8953030,
+    0xfdc20d2b36ba7c3d, 0x3d32907604691b4c,
+    0xa63f9a49c2c1b10f, 0xfcf80dc33721d53,
+    0xd3c36113404ea4a8, 0x645a1cac083126e9,
+    0x3d70a3d70a3d70a3, 0xcccccccccccccccc,
     0x0, 0x0,
     0x0, 0x0,
     0x0, 0x0,
@@ -752,204 +864,189 @@ really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
     0x0, 0x0,
     0x0, 0x0,
     0x0, 0x0,
-    0x0, 0x4000000000000000,
-    0x5000000000000000, 0xa400000000000000,
-    0x4d00000000000000, 0xf020000000000000,
-    0x6c28000000000000, 0xc732000000000000,
-    0x3c7f400000000000, 0x4b9f100000000000,
-    0x1e86d40000000000, 0x1314448000000000,
-    0x17d955a000000000, 0x5dcfab0800000000,
-    0x5aa1cae500000000, 0xf14a3d9e40000000,
-    0x6d9ccd05d0000000, 0xe4820023a2000000,
-    0xdda2802c8a800000, 0xd50b2037ad200000,
-    0x4526f422cc340000, 0x9670b12b7f410000,
-    0x3c0cdd765f114000, 0xa5880a69fb6ac800,
-    0x8eea0d047a457a00, 0x72a4904598d6d880,
-    0x47a6da2b7f864750, 0x999090b65f67d924,
-    0xfff4b4e3f741cf6d, 0xbff8f10e7a8921a4,
-    0xaff72d52192b6a0d, 0x9bf4f8a69f764490,
-    0x2f236d04753d5b4, 0x1d762422c946590,
-    0x424d3ad2b7b97ef5, 0xd2e0898765a7deb2,
-    0x63cc55f49f88eb2f, 0x3cbf6b71c76b25fb,
-    0x8bef464e3945ef7a, 0x97758bf0e3cbb5ac,
-    0x3d52eeed1cbea317, 0x4ca7aaa863ee4bdd,
-    0x8fe8caa93e74ef6a, 0xb3e2fd538e122b44,
-    0x60dbbca87196b616, 0xbc8955e946fe31cd,
-    0x6babab6398bdbe41, 0xc696963c7eed2dd1,
-    0xfc1e1de5cf543ca2, 0x3b25a55f43294bcb,
-    0x49ef0eb713f39ebe, 0x6e3569326c784337,
-    0x49c2c37f07965404, 0xdc33745ec97be906,
-    0x69a028bb3ded71a3, 0xc40832ea0d68ce0c,
-    0xf50a3fa490c30190, 0x792667c6da79e0fa,
-    0x577001b891185938, 0xed4c0226b55e6f86,
-    0x544f8158315b05b4, 0x696361ae3db1c721,
-    0x3bc3a19cd1e38e9, 0x4ab48a04065c723,
-    0x62eb0d64283f9c76, 0x3ba5d0bd324f8394,
-    0xca8f44ec7ee36479, 0x7e998b13cf4e1ecb,
-    0x9e3fedd8c321a67e, 0xc5cfe94ef3ea101e,
-    0xbba1f1d158724a12, 0x2a8a6e45ae8edc97,
-    0xf52d09d71a3293bd, 0x593c2626705f9c56,
-    0x6f8b2fb00c77836c, 0xb6dfb9c0f956447,
-    0x4724bd4189bd5eac, 0x58edec91ec2cb657,
-    0x2f2967b66737e3ed, 0xbd79e0d20082ee74,
-    0xecd8590680a3aa11, 0xe80e6f4820cc9495,
-    0x3109058d147fdcdd, 0xbd4b46f0599fd415,
-    0x6c9e18ac7007c91a, 0x3e2cf6bc604ddb0,
-    0x84db8346b786151c, 0xe612641865679a63,
-    0x4fcb7e8f3f60c07e, 0xe3be5e330f38f09d,
-    0x5cadf5bfd3072cc5, 0x73d9732fc7c8f7f6,
-    0x2867e7fddcdd9afa, 0xb281e1fd541501b8,
-    0x1f225a7ca91a4226, 0x3375788de9b06958,
-    0x52d6b1641c83ae, 0xc0678c5dbd23a49a,
-    0xf840b7ba963646e0, 0xb650e5a93bc3d898,
-    0xa3e51f138ab4cebe, 0xc66f336c36b10137,
-    0xb80b0047445d4184, 0xa60dc059157491e5,
-    0x87c89837ad68db2f, 0x29babe4598c311fb,
-    0xf4296dd6fef3d67a, 0x1899e4a65f58660c,
-    0x5ec05dcff72e7f8f, 0x76707543f4fa1f73,
-    0x6a06494a791c53a8, 0x487db9d17636892,
-    0x45a9d2845d3c42b6, 0xb8a2392ba45a9b2,
-    0x8e6cac7768d7141e, 0x3207d795430cd926,
-    0x7f44e6bd49e807b8, 0x5f16206c9c6209a6,
-    0x36dba887c37a8c0f, 0xc2494954da2c9789,
-    0xf2db9baa10b7bd6c, 0x6f92829494e5acc7,
-    0xcb772339ba1f17f9, 0xff2a760414536efb,
-    0xfef5138519684aba, 0x7eb258665fc25d69,
-    0xef2f773ffbd97a61, 0xaafb550ffacfd8fa,
-    0x95ba2a53f983cf38, 0xdd945a747bf26183,
-    0x94f971119aeef9e4, 0x7a37cd5601aab85d,
-    0xac62e055c10ab33a, 0x577b986b314d6009,
-    0xed5a7e85fda0b80b, 0x14588f13be847307,
-    0x596eb2d8ae258fc8, 0x6fca5f8ed9aef3bb,
-    0x25de7bb9480d5854, 0xaf561aa79a10ae6a,
-    0x1b2ba1518094da04, 0x90fb44d2f05d0842,
-    0x353a1607ac744a53, 0x42889b8997915ce8,
-    0x69956135febada11, 0x43fab9837e699095,
-    0x94f967e45e03f4bb, 0x1d1be0eebac278f5,
-    0x6462d92a69731732, 0x7d7b8f7503cfdcfe,
-    0x5cda735244c3d43e, 0x3a0888136afa64a7,
-    0x88aaa1845b8fdd0, 0x8aad549e57273d45,
-    0x36ac54e2f678864b, 0x84576a1bb416a7dd,
-    0x656d44a2a11c51d5, 0x9f644ae5a4b1b325,
-    0x873d5d9f0dde1fee, 0xa90cb506d155a7ea,
-    0x9a7f12442d588f2, 0xc11ed6d538aeb2f,
-    0x8f1668c8a86da5fa, 0xf96e017d694487bc,
-    0x37c981dcc395a9ac, 0x85bbe253f47b1417,
-    0x93956d7478ccec8e, 0x387ac8d1970027b2,
-    0x6997b05fcc0319e, 0x441fece3bdf81f03,
-    0xd527e81cad7626c3, 0x8a71e223d8d3b074,
-    0xf6872d5667844e49, 0xb428f8ac016561db,
-    0xe13336d701beba52, 0xecc0024661173473,
-    0x27f002d7f95d0190, 0x31ec038df7b441f4,
-    0x7e67047175a15271, 0xf0062c6e984d386,
-    0x52c07b78a3e60868, 0xa7709a56ccdf8a82,
-    0x88a66076400bb691, 0x6acff893d00ea435,
-    0x583f6b8c4124d43, 0xc3727a337a8b704a,
-    0x744f18c0592e4c5c, 0x1162def06f79df73,
-    0x8addcb5645ac2ba8, 0x6d953e2bd7173692,
-    0xc8fa8db6ccdd0437, 0x1d9c9892400a22a2,
-    0x2503beb6d00cab4b, 0x2e44ae64840fd61d,
-    0x5ceaecfed289e5d2, 0x7425a83e872c5f47,
-    0xd12f124e28f77719, 0x82bd6b70d99aaa6f,
-    0x636cc64d1001550b, 0x3c47f7e05401aa4e,
-    0x65acfaec34810a71, 0x7f1839a741a14d0d,
-    0x1ede48111209a050, 0x934aed0aab460432,
-    0xf81da84d5617853f, 0x36251260ab9d668e,
-    0xc1d72b7c6b426019, 0xb24cf65b8612f81f,
-    0xdee033f26797b627, 0x169840ef017da3b1,
-    0x8e1f289560ee864e, 0xf1a6f2bab92a27e2,
-    0xae10af696774b1db, 0xacca6da1e0a8ef29,
-    0x17fd090a58d32af3, 0xddfc4b4cef07f5b0,
-    0x4abdaf101564f98e, 0x9d6d1ad41abe37f1,
-    0x84c86189216dc5ed, 0x32fd3cf5b4e49bb4,
-    0x3fbc8c33221dc2a1, 0xfabaf3feaa5334a,
-    0x29cb4d87f2a7400e, 0x743e20e9ef511012,
-    0x914da9246b255416, 0x1ad089b6c2f7548e,
-    0xa184ac2473b529b1, 0xc9e5d72d90a2741e,
-    0x7e2fa67c7a658892, 0xddbb901b98feeab7,
-    0x552a74227f3ea565, 0xd53a88958f87275f,
-    0x8a892abaf368f137, 0x2d2b7569b0432d85,
-    0x9c3b29620e29fc73, 0x8349f3ba91b47b8f,
-    0x241c70a936219a73, 0xed238cd383aa0110,
-    0xf4363804324a40aa, 0xb143c6053edcd0d5,
-    0xdd94b7868e94050a, 0xca7cf2b4191c8326,
-    0xfd1c2f611f63a3f0, 0xbc633b39673c8cec,
-    0xd5be0503e085d813, 0x4b2d8644d8a74e18,
-    0xddf8e7d60ed1219e, 0xcabb90e5c942b503,
-    0x3d6a751f3b936243, 0xcc512670a783ad4,
-    0x27fb2b80668b24c5, 0xb1f9f660802dedf6,
-    0x5e7873f8a0396973, 0xdb0b487b6423e1e8,
-    0x91ce1a9a3d2cda62, 0x7641a140cc7810fb,
-    0xa9e904c87fcb0a9d, 0x546345fa9fbdcd44,
-    0xa97c177947ad4095, 0x49ed8eabcccc485d,
-    0x5c68f256bfff5a74, 0x73832eec6fff3111,
-    0xc831fd53c5ff7eab, 0xba3e7ca8b77f5e55,
-    0x28ce1bd2e55f35eb, 0x7980d163cf5b81b3,
-    0xd7e105bcc332621f, 0x8dd9472bf3fefaa7,
-    0xb14f98f6f0feb951, 0x6ed1bf9a569f33d3,
-    0xa862f80ec4700c8, 0xcd27bb612758c0fa,
-    0x8038d51cb897789c, 0xe0470a63e6bd56c3,
-    0x1858ccfce06cac74, 0xf37801e0c43ebc8,
-    0xd30560258f54e6ba, 0x47c6b82ef32a2069,
-    0x4cdc331d57fa5441, 0xe0133fe4adf8e952,
-    0x58180fddd97723a6, 0x570f09eaa7ea7648,};
+    0x0, 0x0,
+    0x4000000000000000, 0x5000000000000000,
+    0xa400000000000000, 0x4d00000000000000,
+    0xf020000000000000, 0x6c28000000000000,
+    0xc732000000000000, 0x3c7f400000000000,
+    0x4b9f100000000000, 0x1e86d40000000000,
+    0x1314448000000000, 0x17d955a000000000,
+    0x5dcfab0800000000, 0x5aa1cae500000000,
+    0xf14a3d9e40000000, 0x6d9ccd05d0000000,
+    0xe4820023a2000000, 0xdda2802c8a800000,
+    0xd50b2037ad200000, 0x4526f422cc340000,
+    0x9670b12b7f410000, 0x3c0cdd765f114000,
+    0xa5880a69fb6ac800, 0x8eea0d047a457a00,
+    0x72a4904598d6d880, 0x47a6da2b7f864750,
+    0x999090b65f67d924, 0xfff4b4e3f741cf6d,
+    0xbff8f10e7a8921a4, 0xaff72d52192b6a0d,
+    0x9bf4f8a69f764490, 0x2f236d04753d5b4,
+    0x1d762422c946590, 0x424d3ad2b7b97ef5,
+    0xd2e0898765a7deb2, 0x63cc55f49f88eb2f,
+    0x3cbf6b71c76b25fb, 0x8bef464e3945ef7a,
+    0x97758bf0e3cbb5ac, 0x3d52eeed1cbea317,
+    0x4ca7aaa863ee4bdd, 0x8fe8caa93e74ef6a,
+    0xb3e2fd538e122b44, 0x60dbbca87196b616,
+    0xbc8955e946fe31cd, 0x6babab6398bdbe41,
+    0xc696963c7eed2dd1, 0xfc1e1de5cf543ca2,
+    0x3b25a55f43294bcb, 0x49ef0eb713f39ebe,
+    0x6e3569326c784337, 0x49c2c37f07965404,
+    0xdc33745ec97be906, 0x69a028bb3ded71a3,
+    0xc40832ea0d68ce0c, 0xf50a3fa490c30190,
+    0x792667c6da79e0fa, 0x577001b891185938,
+    0xed4c0226b55e6f86, 0x544f8158315b05b4,
+    0x696361ae3db1c721, 0x3bc3a19cd1e38e9,
+    0x4ab48a04065c723, 0x62eb0d64283f9c76,
+    0x3ba5d0bd324f8394, 0xca8f44ec7ee36479,
+    0x7e998b13cf4e1ecb, 0x9e3fedd8c321a67e,
+    0xc5cfe94ef3ea101e, 0xbba1f1d158724a12,
+    0x2a8a6e45ae8edc97, 0xf52d09d71a3293bd,
+    0x593c2626705f9c56, 0x6f8b2fb00c77836c,
+    0xb6dfb9c0f956447, 0x4724bd4189bd5eac,
+    0x58edec91ec2cb657, 0x2f2967b66737e3ed,
+    0xbd79e0d20082ee74, 0xecd8590680a3aa11,
+    0xe80e6f4820cc9495, 0x3109058d147fdcdd,
+    0xbd4b46f0599fd415, 0x6c9e18ac7007c91a,
+    0x3e2cf6bc604ddb0, 0x84db8346b786151c,
+    0xe612641865679a63, 0x4fcb7e8f3f60c07e,
+    0xe3be5e330f38f09d, 0x5cadf5bfd3072cc5,
+    0x73d9732fc7c8f7f6, 0x2867e7fddcdd9afa,
+    0xb281e1fd541501b8, 0x1f225a7ca91a4226,
+    0x3375788de9b06958, 0x52d6b1641c83ae,
+    0xc0678c5dbd23a49a, 0xf840b7ba963646e0,
+    0xb650e5a93bc3d898, 0xa3e51f138ab4cebe,
+    0xc66f336c36b10137, 0xb80b0047445d4184,
+    0xa60dc059157491e5, 0x87c89837ad68db2f,
+    0x29babe4598c311fb, 0xf4296dd6fef3d67a,
+    0x1899e4a65f58660c, 0x5ec05dcff72e7f8f,
+    0x76707543f4fa1f73, 0x6a06494a791c53a8,
+    0x487db9d17636892, 0x45a9d2845d3c42b6,
+    0xb8a2392ba45a9b2, 0x8e6cac7768d7141e,
+    0x3207d795430cd926, 0x7f44e6bd49e807b8,
+    0x5f16206c9c6209a6, 0x36dba887c37a8c0f,
+    0xc2494954da2c9789, 0xf2db9baa10b7bd6c,
+    0x6f92829494e5acc7, 0xcb772339ba1f17f9,
+    0xff2a760414536efb, 0xfef5138519684aba,
+    0x7eb258665fc25d69, 0xef2f773ffbd97a61,
+    0xaafb550ffacfd8fa, 0x95ba2a53f983cf38,
+    0xdd945a747bf26183, 0x94f971119aeef9e4,
+    0x7a37cd5601aab85d, 0xac62e055c10ab33a,
+    0x577b986b314d6009, 0xed5a7e85fda0b80b,
+    0x14588f13be847307, 0x596eb2d8ae258fc8,
+    0x6fca5f8ed9aef3bb, 0x25de7bb9480d5854,
+    0xaf561aa79a10ae6a, 0x1b2ba1518094da04,
+    0x90fb44d2f05d0842, 0x353a1607ac744a53,
+    0x42889b8997915ce8, 0x69956135febada11,
+    0x43fab9837e699095, 0x94f967e45e03f4bb,
+    0x1d1be0eebac278f5, 0x6462d92a69731732,
+    0x7d7b8f7503cfdcfe, 0x5cda735244c3d43e,
+    0x3a0888136afa64a7, 0x88aaa1845b8fdd0,
+    0x8aad549e57273d45, 0x36ac54e2f678864b,
+    0x84576a1bb416a7dd, 0x656d44a2a11c51d5,
+    0x9f644ae5a4b1b325, 0x873d5d9f0dde1fee,
+    0xa90cb506d155a7ea, 0x9a7f12442d588f2,
+    0xc11ed6d538aeb2f, 0x8f1668c8a86da5fa,
+    0xf96e017d694487bc, 0x37c981dcc395a9ac,
+    0x85bbe253f47b1417, 0x93956d7478ccec8e,
+    0x387ac8d1970027b2, 0x6997b05fcc0319e,
+    0x441fece3bdf81f03, 0xd527e81cad7626c3,
+    0x8a71e223d8d3b074, 0xf6872d5667844e49,
+    0xb428f8ac016561db, 0xe13336d701beba52,
+    0xecc0024661173473, 0x27f002d7f95d0190,
+    0x31ec038df7b441f4, 0x7e67047175a15271,
+    0xf0062c6e984d386, 0x52c07b78a3e60868,
+    0xa7709a56ccdf8a82, 0x88a66076400bb691,
+    0x6acff893d00ea435, 0x583f6b8c4124d43,
+    0xc3727a337a8b704a, 0x744f18c0592e4c5c,
+    0x1162def06f79df73, 0x8addcb5645ac2ba8,
+    0x6d953e2bd7173692, 0xc8fa8db6ccdd0437,
+    0x1d9c9892400a22a2, 0x2503beb6d00cab4b,
+    0x2e44ae64840fd61d, 0x5ceaecfed289e5d2,
+    0x7425a83e872c5f47, 0xd12f124e28f77719,
+    0x82bd6b70d99aaa6f, 0x636cc64d1001550b,
+    0x3c47f7e05401aa4e, 0x65acfaec34810a71,
+    0x7f1839a741a14d0d, 0x1ede48111209a050,
+    0x934aed0aab460432, 0xf81da84d5617853f,
+    0x36251260ab9d668e, 0xc1d72b7c6b426019,
+    0xb24cf65b8612f81f, 0xdee033f26797b627,
+    0x169840ef017da3b1, 0x8e1f289560ee864e,
+    0xf1a6f2bab92a27e2, 0xae10af696774b1db,
+    0xacca6da1e0a8ef29, 0x17fd090a58d32af3,
+    0xddfc4b4cef07f5b0, 0x4abdaf101564f98e,
+    0x9d6d1ad41abe37f1, 0x84c86189216dc5ed,
+    0x32fd3cf5b4e49bb4, 0x3fbc8c33221dc2a1,
+    0xfabaf3feaa5334a, 0x29cb4d87f2a7400e,
+    0x743e20e9ef511012, 0x914da9246b255416,
+    0x1ad089b6c2f7548e, 0xa184ac2473b529b1,
+    0xc9e5d72d90a2741e, 0x7e2fa67c7a658892,
+    0xddbb901b98feeab7, 0x552a74227f3ea565,
+    0xd53a88958f87275f, 0x8a892abaf368f137,
+    0x2d2b7569b0432d85, 0x9c3b29620e29fc73,
+    0x8349f3ba91b47b8f, 0x241c70a936219a73,
+    0xed238cd383aa0110, 0xf4363804324a40aa,
+    0xb143c6053edcd0d5, 0xdd94b7868e94050a,
+    0xca7cf2b4191c8326, 0xfd1c2f611f63a3f0,
+    0xbc633b39673c8cec, 0xd5be0503e085d813,
+    0x4b2d8644d8a74e18, 0xddf8e7d60ed1219e,
+    0xcabb90e5c942b503, 0x3d6a751f3b936243,
+    0xcc512670a783ad4, 0x27fb2b80668b24c5,
+    0xb1f9f660802dedf6, 0x5e7873f8a0396973,
+    0xdb0b487b6423e1e8, 0x91ce1a9a3d2cda62,
+    0x7641a140cc7810fb, 0xa9e904c87fcb0a9d,
+    0x546345fa9fbdcd44, 0xa97c177947ad4095,
+    0x49ed8eabcccc485d, 0x5c68f256bfff5a74,
+    0x73832eec6fff3111, 0xc831fd53c5ff7eab,
+    0xba3e7ca8b77f5e55, 0x28ce1bd2e55f35eb,
+    0x7980d163cf5b81b3, 0xd7e105bcc332621f,
+    0x8dd9472bf3fefaa7, 0xb14f98f6f0feb951,
+    0x6ed1bf9a569f33d3, 0xa862f80ec4700c8,
+    0xcd27bb612758c0fa, 0x8038d51cb897789c,
+    0xe0470a63e6bd56c3, 0x1858ccfce06cac74,
+    0xf37801e0c43ebc8, 0xd30560258f54e6ba,
+    0x47c6b82ef32a2069, 0x4cdc331d57fa5441,
+    0xe0133fe4adf8e952, 0x58180fddd97723a6,
+    0x570f09eaa7ea7648,};
 
-  // we start with a fast path
-  // It was described in
-  // Clinger WD. How to read floating point numbers accurately.
-  // ACM SIGPLAN Notices. 1990
-#if (FLT_EVAL_METHOD != 1) && (FLT_EVAL_METHOD != 0)
-  // we do not trust the divisor
-  if (0 <= power && power <= 22 && i <= 9007199254740991) {
-#else
-  if (-22 <= power && power <= 22 && i <= 9007199254740991) {
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+extern template struct powers_template<void>;
 #endif
-    // convert the integer into a double. This is lossless since
-    // 0 <= i <= 2^53 - 1.
-    double d = double(i);
-    //
-    // The general idea is as follows.
-    // If 0 <= s < 2^53 and if 10^0 <= p <= 10^22 then
-    // 1) Both s and p can be represented exactly as 64-bit floating-point
-    // values
-    // (binary64).
-    // 2) Because s and p can be represented exactly as floating-point values,
-    // then s * p
-    // and s / p will produce correctly rounded values.
-    //
-    if (power < 0) {
-      d = d / power_of_ten[-power];
-    } else {
-      d = d * power_of_ten[power];
+
+typedef powers_template<> powers;
+
+// Computes the most significant bits of w * 10^q, with w normalized (most
+// significant bit set), using 128-bit truncated powers of five. The second
+// half of the power is only needed when the first product is not precise
+// enough in its bit_precision most significant bits.
+template <int bit_precision>
+really_inline value128 compute_product_approximation(int64_t q, uint64_t w) {
+  const int index = int(q - FASTFLOAT_SMALLEST_POWER);
+  value128 firstproduct = full_multiplication(w, powers::mantissa_64[index]);
+  const uint64_t precision_mask = uint64_t(0xFFFFFFFFFFFFFFFF) >> bit_precision;
+  if ((firstproduct.high & precision_mask) == precision_mask) {
+    value128 secondproduct =
+        full_multiplication(w, powers::mantissa_128[index]);
+    // The tables truncate 10^q, but the midpoint detection needs the
+    // reciprocals of 5^-q rounded up when they are exact within 128 bits.
+    if ((q < 0) && (q >= -27)) {
+      secondproduct.low += w;
+      if (secondproduct.low < w) {
+        secondproduct.high++;
+      }
     }
-    if (negative) {
-      d = -d;
+    firstproduct.low += secondproduct.high;
+    if (secondproduct.high > firstproduct.low) {
+      firstproduct.high++;
     }
-    *success = true;
-    return d;
   }
-  // When 22 < power && power <  22 + 16, we could
-  // hope for another, secondary fast path.  It wa
-  // described by David M. Gay in  "Correctly rounded
-  // binary-decimal and decimal-binary conversions." (1990)
-  // If you need to compute i * 10^(22 + x) for x < 16,
-  // first compute i * 10^x, if you know that result is exact
-  // (e.g., when i * 10^x < 2^53),
-  // then you can still proceed and do (i * 10^x) * 10^22.
-  // Is this worth your time?
-  // You need  22 < power *and* power <  22 + 16 *and* (i * 10^(x-22) < 2^53)
-  // for this second fast path to work.
-  // If you you have 22 < power *and* power <  22 + 16, and then you
-  // optimistically compute "i * 10^(x-22)", there is still a chance that you
-  // have wasted your time if i * 10^(x-22) >= 2^53. It makes the use cases of
-  // this optimization maybe less common than we would like. Source:
-  // http://www.exploringbinary.com/fast-path-decimal-to-floating-point-conversion/
-  // also used in RapidJSON: https://rapidjson.org/strtod_8h_source.html
-
-
-
-  // The fast path has now failed, so we are failing back on the slower path.
+  return firstproduct;
+}
 
+// Computes i * 10^(power), like compute_float_64, when the Clinger fast path
+// does not apply, with the algorithm of Eisel and Lemire.
+template <typename unused = void>
+FAST_DOUBLE_PARSER_OUT_OF_LINE double
+compute_float_eisel_lemire(int64_t power, uint64_t i, bool negative,
+                           bool *success) {
   // In the slow path, we need to adjust i so that it is > 1<<63 which is always
   // possible, except if i == 0, so we handle i == 0 separately.
   if(i == 0) {
@@ -957,16 +1054,6 @@ really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
   }
 
 
-  // We are going to need to do some 64-bit arithmetic to get a more precise product.
-  // We use a table lookup approach.
-  // It is safe because
-  // power >= FASTFLOAT_SMALLEST_POWER
-  // and power <= FASTFLOAT_LARGEST_POWER
-  // We recover the mantissa of the power, it has a leading 1. It is always
-  // rounded down.
-  uint64_t factor_mantissa = mantissa_64[power - FASTFLOAT_SMALLEST_POWER];
-  
-
   // The exponent is 1024 + 63 + power 
   //     + floor(log(5**power)/log(2)).
   // The 1024 comes from the ieee64 standard.
@@ -998,50 +1085,18 @@ really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
   // We want the most significant bit of i to be 1. Shift if needed.
   int lz = leading_zeroes(i);
   i <<= lz;
-  // We want the most significant 64 bits of the product. We know
-  // this will be non-zero because the most significant bit of i is
-  // 1.
-  value128 product = full_multiplication(i, factor_mantissa);
+  // We want the most significant 64 bits of the product, plus enough of the
+  // next bits to recognize exact midpoints. We know the high word will be
+  // non-zero because the most significant bit of i is 1.
+  //
+  // The 64-bit truncated power of five gives us the leading 55 bits exactly
+  // unless they end with nine ones, in which case we use the next 64 bits of
+  // the power. Mushtak and Lemire ("Fast number parsing without fallback",
+  // Software: Practice and Experience, 2023) show that the 128-bit product
+  // is then always enough, so that we never need to bail out.
+  value128 product = compute_product_approximation<55>(power, i);
   uint64_t lower = product.low;
   uint64_t upper = product.high;
-  // We know that upper has at most one leading zero because
-  // both i and  factor_mantissa have a leading one. This means
-  // that the result is at least as large as ((1<<63)*(1<<63))/(1<<64).
-
-  // As long as the first 9 bits of "upper" are not "1", then we
-  // know that we have an exact computed value for the leading
-  // 55 bits because any imprecision would play out as a +1, in
-  // the worst case.
-  // Having 55 bits is necessary because
-  // we need 53 bits for the mantissa but we have to have one rounding bit and
-  // we can waste a bit if the most significant bit of the product is zero.
-  // We expect this next branch to be rarely taken (say 1% of the time).
-  // When (upper & 0x1FF) == 0x1FF, it can be common for
-  // lower + i < lower to be true (proba. much higher than 1%).
-  if (unlikely((upper & 0x1FF) == 0x1FF) && (lower + i < lower)) {
-    uint64_t factor_mantissa_low =
-        mantissa_128[power - FASTFLOAT_SMALLEST_POWER];
-    // next, we compute the 64-bit x 128-bit multiplication, getting a 192-bit
-    // result (three 64-bit values)
-    product = full_multiplication(i, factor_mantissa_low);
-    uint64_t product_low = product.low;
-    uint64_t product_middle2 = product.high;
-    uint64_t product_middle1 = lower;
-    uint64_t product_high = upper;
-    uint64_t product_middle = product_middle1 + product_middle2;
-    if (product_middle < product_middle1) {
-      product_high++; // overflow carry
-    }
-    // we want to check whether mantissa *i + i would affect our result
-    // This does happen, e.g. with 7.3177701707893310e+15
-    if (((product_middle + 1 == 0) && ((product_high & 0x1FF) == 0x1FF) &&
-         (product_low + i < product_low))) { // let us be prudent and bail out.
-      *success = false;
-      return 0;
-    }
-    upper = product_high;
-    lower = product_middle;
-  }
   // The final mantissa should be 53 bits with a leading 1.
   // We shift it so that it occupies 54 bits with a leading 1.
   ///////
@@ -1049,33 +1104,39 @@ really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
   uint64_t mantissa = upper >> (upperbit + 9);
   lz += int(1 ^ upperbit);
   // Here we have mantissa < (1<<54).
+  int64_t real_exponent = exponent - lz;
+  if (unlikely(real_exponent <= 0)) {
+    // The result is subnormal, or zero: we shift the mantissa to the
+    // exponent of the subnormals, then round. Exact midpoints between
+    // subnormals need more than 64 bits of significand, so we never have to
+    // round to even.
+    if (-real_exponent + 1 >= 64) {
+      mantissa = 0;
+    } else {
+      mantissa >>= -real_exponent + 1;
+      mantissa += (mantissa & 1);
+      mantissa >>= 1;
+    }
+    // If we rounded up to the smallest normal value, (1<<52) is its
+    // exponent.
+    mantissa |= (((uint64_t)negative) << 63);
+    double d;
+    memcpy(&d, &mantissa, sizeof(d));
+    *success = true;
+    return d;
+  }
 
-  // We have to round to even. The "to even" part
-  // is only a problem when we are right in between two floats
-  // which we guard against.
-  // If we have lots of trailing zeros, we may fall right between two
-  // floating-point values.
-  if (unlikely((lower == 0) && ((upper & 0x1FF) == 0) &&
-               ((mantissa & 3) == 1))) {
-      // if mantissa & 1 == 1 we might need to round up.
-      //
-      // Scenarios:
-      // 1. We are not in the middle. Then we should round up.
-      //
-      // 2. We are right in the middle. Whether we round up depends
-      // on the last significant bit: if it is "one" then we round
-      // up (round to even) otherwise, we do not.
-      //
-      // So if the last significant bit is 1, we can safely round up.
-      // Hence we only need to bail out if (mantissa & 3) == 1.
-      // Otherwise we may need more accuracy or analysis to determine whether
-      // we are exactly between two floating-point numbers.
-      // It can be triggered with 1e23.
-      // Note: because the factor_mantissa and factor_mantissa_low are
-      // almost always rounded down (except for small positive powers),
-      // almost always should round up.
-      *success = false;
-      return 0;
+  // We usually round up, but if we are right between two floats, we round
+  // to even. An exact midpoint w * 10^q needs 5^|q| < 2^64, with q in
+  // [-4, 23] (for q < 0, w must also be divisible by 5^-q). The product is
+  // then exact, so all the bits we shifted out must be zero: a one in the
+  // least significant bit of mantissa followed by zeros. We clear that
+  // bit so that we round down when mantissa is even. This happens with
+  // 1e23 and 9007199254740995.
+  if (unlikely((lower <= 1) && (power >= -4) && (power <= 23) &&
+               ((mantissa & 3) == 1) &&
+               ((mantissa << (upperbit + 9)) == upper))) {
+    mantissa &= ~uint64_t(1);
   }
   mantissa += mantissa & 1;
   mantissa >>= 1;
@@ -1085,24 +1146,125 @@ really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
     // This will happen when parsing values such as 7.2057594037927933e+16
     ////////
     mantissa = (1ULL << 52);
-    lz--; // undo previous addition
+    real_exponent++;
   }
   mantissa &= ~(1ULL << 52);
-  uint64_t real_exponent = exponent - lz;
   // we have to check that real_exponent is in range, otherwise we bail out
-  if (unlikely((real_exponent < 1) || (real_exponent > 2046))) {
+  if (unlikely(real_exponent > 2046)) {
     *success = false;
     return 0;
   }
-  mantissa |= real_exponent << 52;
+  mantissa |= uint64_t(real_exponent) << 52;
   mantissa |= (((uint64_t)negative) << 63);
   double d;
   memcpy(&d, &mantissa, sizeof(d));
   *success = true;
   return d;
 }
+
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+extern template double compute_float_eisel_lemire<void>(int64_t, uint64_t,
+                                                        bool, bool *);
+#endif
+
+// Attempts to compute i * 10^(power) exactly; and if "negative" is
+// true, negate the result.
+// When the result is too large for a double, success is set to false.
+// We assume that power is in the [FASTFLOAT_SMALLEST_POWER,
+// FASTFLOAT_LARGEST_POWER] interval: the caller is responsible for this check.
+really_inline double compute_float_64(int64_t power, uint64_t i, bool negative,
+                                      bool *success) {
+
+  // Precomputed powers of ten from 10^0 to 10^22. These
+  // can be represented exactly using the double type.
+  static const double power_of_ten[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+
+  // we start with a fast path
+  // It was described in
+  // Clinger WD. How to read floating point numbers accurately.
+  // ACM SIGPLAN Notices. 1990
+#if (FLT_EVAL_METHOD != 1) && (FLT_EVAL_METHOD != 0)
+  // we do not trust the divisor
+  if (0 <= power && power <= 22 && i <= 9007199254740991) {
+#else
+  if (-22 <= power && power <= 22 && i <= 9007199254740991) {
+#endif
+    // convert the integer into a double. This is lossless since
+    // 0 <= i <= 2^53 - 1.
+    double d = double(i);
+    //
+    // The general idea is as follows.
+    // If 0 <= s < 2^53 and if 10^0 <= p <= 10^22 then
+    // 1) Both s and p can be represented exactly as 64-bit floating-point
+    // values
+    // (binary64).
+    // 2) Because s and p can be represented exactly as floating-point values,
+    // then s * p
+    // and s / p will produce correctly rounded values.
+    //
+    if (power < 0) {
+      d = d / power_of_ten[-power];
+    } else {
+      d = d * power_of_ten[power];
+    }
+    if (negative) {
+      d = -d;
+    }
+    *success = true;
+    return d;
+  }
+  // When 22 < power && power <  22 + 16, we could
+  // hope for another, secondary fast path.  It wa
+  // described by David M. Gay in  "Correctly rounded
+  // binary-decimal and decimal-binary conversions." (1990)
+  // If you need to compute i * 10^(22 + x) for x < 16,
+  // first compute i * 10^x, if you know that result is exact
+  // (e.g., when i * 10^x < 2^53),
+  // then you can still proceed and do (i * 10^x) * 10^22.
+  // Is this worth your time?
+  // You need  22 < power *and* power <  22 + 16 *and* (i * 10^(x-22) < 2^53)
+  // for this second fast path to work.
+  // If you you have 22 < power *and* power <  22 + 16, and then you
+  // optimistically compute "i * 10^(x-22)", there is still a chance that you
+  // have wasted your time if i * 10^(x-22) >= 2^53. It makes the use cases of
+  // this optimization maybe less common than we would like. Source:
+  // http://www.exploringbinary.com/fast-path-decimal-to-floating-point-conversion/
+  // also used in RapidJSON: https://rapidjson.org/strtod_8h_source.html
+
+
+
+  // The fast path has now failed, so we are failing back on the slower path.
+  return compute_float_eisel_lemire(power, i, negative, success);
+}
+
+// Decides i * 10^(power), or a number between i and i + 1 times 10^(power),
+// when power is outside the [FASTFLOAT_SMALLEST_POWER,
+// FASTFLOAT_LARGEST_POWER] interval, without strtod. Since i has at most 19
+// digits (i + 1 <= 10^19), a nonzero number is either at least 10^309 when
+// power > 308, which is too large for a double, or below
+// 10^(19 - 343) = 10^-324 when power < -342, which is less than half the
+// smallest subnormal (2^-1074) and rounds to zero.
+// Returns false, with an infinity in *outDouble, when the number is too
+// large for a double.
+really_inline bool compute_float_out_of_range(int64_t power, uint64_t i,
+                                              bool negative,
+                                              double *outDouble) {
+  if ((i == 0) || (power < 0)) {
+    *outDouble = negative ? -0.0 : 0.0;
+    return true;
+  }
+  *outDouble = negative ? -std::numeric_limits<double>::infinity()
+                        : std::numeric_limits<double>::infinity();
+  return false;
+}
+
 // Return the null pointer on error
-static const char * parse_float_strtod(const char *ptr, double *outDouble) {
+template <typename unused = void>
+FAST_DOUBLE_PARSER_COLD never_inline const char *
+parse_float_strtod(const char *ptr, double *outDouble) {
   char *endptr;
 #if defined(FAST_DOUBLE_PARSER_SOLARIS) || defined(FAST_DOUBLE_PARSER_CYGWIN) 
   // workround for cygwin, solaris
@@ -1134,24 +1296,82 @@ static const char * parse_float_strtod(const char *ptr, double *outDouble) {
   return endptr;
 }
 
-// parse the number at p
-// return the null pointer on error
-WARN_UNUSED
-really_inline const char * parse_number(const char *p, double *outDouble) {
-  const char *pinit = p;
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+extern template const char *parse_float_strtod<void>(const char *, double *);
+#endif
+
+// The fallback used once parse_number has scanned a number in [start, end).
+really_inline const char *parse_float_strtod(const char *start, const char *,
+                                             double *outDouble) {
+  return parse_float_strtod(start, outDouble);
+}
+
+// Wider code units are narrowed to a null-terminated copy for strtod. The
+// number was scanned already, so it only holds ASCII characters.
+template <typename UC>
+FAST_DOUBLE_PARSER_COLD never_inline const UC *
+parse_float_strtod(const UC *start, const UC *end, double *outDouble) {
+  size_t length = size_t(end - start);
+  char small_buffer[64];
+  std::string large_buffer;
+  char *buffer = small_buffer;
+  if (length >= sizeof(small_buffer)) {
+    large_buffer.resize(length);
+    buffer = &large_buffer[0];
+  }
+  for (size_t i = 0; i < length; i++) {
+    buffer[i] = char(start[i]);
+  }
+  buffer[length] = '\0';
+  const char *buffer_end = parse_float_strtod(buffer, outDouble);
+  if (buffer_end != buffer + length) {
+    return nullptr;
+  }
+  return end;
+}
+
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+extern template const char *parse_float_strtod<char>(const char *,
+                                                     const char *, double *);
+#endif
+
+// A decimal number, significand * 10^exponent, as read by scan_number.
+struct decimal_number {
+  uint64_t significand;
+  int64_t exponent;
+  bool negative;
+  // true when there are 19 or more significant digits: the significand
+  // may have overflowed and must not be used
+  bool many_digits;
+  // true when there is neither a fraction nor an exponent
+  bool integer;
+};
+
+// Scans the number at p, checking its grammar, and returns a pointer to its
+// end or the null pointer on error.
+// When trusted is true, the input is assumed to be a valid number (see
+// parse_number_trusted) and none of the grammar checks are made.
+template <bool trusted, typename UC>
+really_inline const UC *scan_number(const UC *p, decimal_number *number) {
   bool found_minus = (*p == '-');
   bool negative = false;
   if (found_minus) {
     ++p;
     negative = true;
-    if (!is_integer(*p)) { // a negative sign must be followed by an integer
+    if (!trusted && !is_integer(*p)) { // a negative sign must be followed by an integer
       return nullptr;
     }
   }
-  const char *const start_digits = p;
+  const UC *const start_digits = p;
 
   uint64_t i;      // an unsigned int avoids signed overflows (which are bad)
-  if (*p == '0') { // 0 cannot be followed by an integer
+  if (trusted) {
+    i = 0;
+    while (is_integer(*p)) {
+      i = 10 * i + (unsigned char)(*p - '0');
+      ++p;
+    }
+  } else if (*p == '0') { // 0 cannot be followed by an integer
     ++p;
     if (is_integer(*p)) {
       return nullptr;
@@ -1175,11 +1395,13 @@ really_inline const char * parse_number(const char *p, double *outDouble) {
     }
   }
   int64_t exponent = 0;
-  const char *first_after_period = NULL;
+  const UC *first_after_period = NULL;
   if (*p == '.') {
     ++p;
     first_after_period = p;
-    if (is_integer(*p)) {
+    if (trusted) {
+      // fall through to the loop
+    } else if (is_integer(*p)) {
       unsigned char digit = *p - '0';
       ++p;
       i = i * 10 + digit; // might overflow + multiplication by 10 is likely
@@ -1198,7 +1420,9 @@ really_inline const char * parse_number(const char *p, double *outDouble) {
   }
   int digit_count =
       int(p - start_digits - 1); // used later to guard against overflows
+  bool integer = (first_after_period == NULL);
   if (('e' == *p) || ('E' == *p)) {
+    integer = false;
     ++p;
     bool neg_exp = false;
     if ('-' == *p) {
@@ -1207,68 +1431,2390 @@ really_inline const char * parse_number(const char *p, double *outDouble) {
     } else if ('+' == *p) {
       ++p;
     }
-    if (!is_integer(*p)) {
-      return nullptr;
-    }
-    unsigned char digit = *p - '0';
-    int64_t exp_number = digit;
-    p++;
-    if (is_integer(*p)) {
-      digit = *p - '0';
-      exp_number = 10 * exp_number + digit;
-      ++p;
-    }
-    if (is_integer(*p)) {
-      digit = *p - '0';
-      exp_number = 10 * exp_number + digit;
-      ++p;
-    }
-    while (is_integer(*p)) {
-      digit = *p - '0';
-      if (exp_number < 0x100000000) { // we need to check for overflows
+    if (trusted) {
+      // An unsigned accumulator wraps around instead of overflowing: an
+      // absurd exponent is then caught by the range check below.
+      uint64_t exp_number = 0;
+      while (is_integer(*p)) {
+        exp_number = 10 * exp_number + (unsigned char)(*p - '0');
+        ++p;
+      }
+      exponent += (neg_exp ? -int64_t(exp_number) : int64_t(exp_number));
+    } else {
+      if (!is_integer(*p)) {
+        return nullptr;
+      }
+      unsigned char digit = *p - '0';
+      int64_t exp_number = digit;
+      p++;
+      if (is_integer(*p)) {
+        digit = *p - '0';
         exp_number = 10 * exp_number + digit;
+        ++p;
       }
-      ++p;
+      if (is_integer(*p)) {
+        digit = *p - '0';
+        exp_number = 10 * exp_number + digit;
+        ++p;
+      }
+      while (is_integer(*p)) {
+        digit = *p - '0';
+        if (exp_number < 0x100000000) { // we need to check for overflows
+          exp_number = 10 * exp_number + digit;
+        }
+        ++p;
+      }
+      exponent += (neg_exp ? -exp_number : exp_number);
     }
-    exponent += (neg_exp ? -exp_number : exp_number);
   }
-  // If we frequently had to deal with long strings of digits,
-  // we could extend our code by using a 128-bit integer instead
-  // of a 64-bit integer. However, this is uncommon.
-  if (unlikely((digit_count >= 19))) { // this is uncommon
+  // Long strings of digits are handled by compute_float_many_digits.
+  bool many_digits = false;
+  if (!trusted && unlikely((digit_count >= 19))) { // this is uncommon
     // It is possible that the integer had an overflow.
     // We have to handle the case where we have 0.0000somenumber.
-    const char *start = start_digits;
+    const UC *start = start_digits;
     while (*start == '0' || (*start == '.')) {
       start++;
     }
     // we over-decrement by one when there is a decimal separator
     digit_count -= int(start - start_digits);
-    if (digit_count >= 19) {
-      // Chances are good that we had an overflow!
-      // We start anew.
-      // This will happen in the following examples:
-      // 10000000000000000000000000000000000000000000e+308
-      // 3.1415926535897932384626433832795028841971693993751
-      //
-      return parse_float_strtod(pinit, outDouble);
+    // Chances are good that we had an overflow!
+    // This will happen in the following examples:
+    // 10000000000000000000000000000000000000000000e+308
+    // 3.1415926535897932384626433832795028841971693993751
+    many_digits = (digit_count >= 19);
+  }
+  number->significand = i;
+  number->exponent = exponent;
+  number->negative = negative;
+  number->many_digits = many_digits;
+  number->integer = integer;
+  return p;
+}
+
+// Computes the value of the number [p, end), which has 19 or more
+// significant digits and whose decimal exponent (as computed by
+// scan_number) is exponent, without falling back on strtod.
+// Returns false if the result could not be proven correct. A number too
+// large for a double gives an infinity.
+//
+// We keep the first 19 significant digits as w, which fits in 64 bits, and
+// note whether any of the dropped digits is nonzero. If none is, w is exact.
+// Otherwise the number is strictly between w and w + 1 (times a power of
+// ten), and if both round to the same double, so does the number.
+template <typename UC>
+FAST_DOUBLE_PARSER_COLD never_inline bool
+compute_float_many_digits(const UC *p, const UC *end, int64_t exponent,
+                          bool negative, double *outDouble) {
+  uint64_t w = 0;
+  int kept = 0;
+  int64_t dropped = 0;
+  bool nonzero_tail = false;
+  if (*p == '-') {
+    p++;
+  }
+  for (; (p != end) && (*p != 'e') && (*p != 'E'); p++) {
+    if (*p == '.') {
+      continue;
+    }
+    if (kept < 19) {
+      // leading zeros are not significant
+      if ((kept > 0) || (*p != '0')) {
+        w = 10 * w + uint64_t(*p - '0');
+        kept++;
+      }
+    } else {
+      dropped++;
+      nonzero_tail |= (*p != '0');
     }
   }
-  if (unlikely(exponent < FASTFLOAT_SMALLEST_POWER) ||
+  exponent += dropped;
+  if ((exponent < FASTFLOAT_SMALLEST_POWER) ||
       (exponent > FASTFLOAT_LARGEST_POWER)) {
-    // this is almost never going to get called!!!
-    // exponent could be as low as 325
-    return parse_float_strtod(pinit, outDouble);
+    compute_float_out_of_range(exponent, w, negative, outDouble);
+    return true;
   }
-  // from this point forward, exponent >= FASTFLOAT_SMALLEST_POWER and
-  // exponent <= FASTFLOAT_LARGEST_POWER
   bool success = true;
-  *outDouble = compute_float_64(exponent, i, negative, &success);
+  double d = compute_float_64(exponent, w, negative, &success);
   if (!success) {
-    // we are almost never going to get here.
-    return parse_float_strtod(pinit, outDouble);
+    // w * 10^exponent, and thus the number, is too large for a double
+    *outDouble = negative ? -std::numeric_limits<double>::infinity()
+                          : std::numeric_limits<double>::infinity();
+    return true;
   }
-  return p;
+  if (nonzero_tail) {
+    // w + 1 <= 10^19 still fits
+    double next = compute_float_64(exponent, w + 1, negative, &success);
+    success = success && (next == d);
+  }
+  if (success) {
+    *outDouble = d;
+  }
+  return success;
+}
+
+#ifdef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+extern template bool compute_float_many_digits<char>(const char *,
+                                                     const char *, int64_t,
+                                                     bool, double *);
+#endif
+
+// Converts the scanned number [p, end) to a double. Returns end, or the null
+// pointer if the number is too large for a double.
+template <typename UC>
+really_inline const UC *compute_double(const decimal_number &number,
+                                       const UC *p, const UC *end,
+                                       double *outDouble) {
+  if (unlikely(number.many_digits)) {
+    if (compute_float_many_digits(p, end, number.exponent, number.negative,
+                                  outDouble)) {
+      return std::isinf(*outDouble) ? nullptr : end;
+    }
+    // We start anew.
+    return parse_float_strtod(p, end, outDouble);
+  }
+  if (unlikely(number.exponent < FASTFLOAT_SMALLEST_POWER) ||
+      (number.exponent > FASTFLOAT_LARGEST_POWER)) {
+    // zero (like 0e999), underflow (like 1e-400) or overflow (like 1e400)
+    return compute_float_out_of_range(number.exponent, number.significand,
+                                      number.negative, outDouble)
+               ? end
+               : nullptr;
+  }
+  // from this point forward, exponent >= FASTFLOAT_SMALLEST_POWER and
+  // exponent <= FASTFLOAT_LARGEST_POWER
+  bool success = true;
+  *outDouble = compute_float_64(number.exponent, number.significand,
+                                number.negative, &success);
+  // compute_float_64 only fails on numbers too large for a double
+  return success ? end : nullptr;
+}
+
+template <bool trusted, typename UC>
+really_inline const UC *parse_number_impl(const UC *p, double *outDouble) {
+  decimal_number number;
+  const UC *end = scan_number<trusted>(p, &number);
+  if (end == nullptr) {
+    return nullptr;
+  }
+  return compute_double(number, p, end, outDouble);
+}
+
+// parse the number at p
+// return the null pointer on error
+WARN_UNUSED
+really_inline const char * parse_number(const char *p, double *outDouble) {
+  return parse_number_impl<false>(p, outDouble);
+}
+
+// Same as above, for input made of wider code units (char16_t and char32_t
+// from UTF-16 and UTF-32 buffers, wchar_t, or char8_t and unsigned char for
+// UTF-8 bytes). Numbers are parsed in place: only the rare inputs that fall
+// back on strtod are copied.
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number(const UC *p,
+                                                 double *outDouble) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  return parse_number_impl<false>(p, outDouble);
+}
+
+// Like parse_number, but for input that is known to be valid: it skips the
+// checks of the number grammar (leading zeros, digits after the period and
+// the exponent sign), the exponent overflow guard and the rescan of long
+// significands. The result is still correctly rounded.
+//
+// This is unsafe: the input must be a finite number following RFC 7159 with
+// at most 19 significant digits. Other input gives unspecified results (but
+// no out-of-bounds read as long as the number is followed by a non-number
+// character). The null pointer is returned only if the value does not fit
+// in binary64.
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number_trusted(const UC *p,
+                                                         double *outDouble) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  return parse_number_impl<true>(p, outDouble);
+}
+
+/**
+ * Half and single precision output.
+ *
+ * Machine-learning workloads often store values as IEEE binary16 (half
+ * precision) or as bfloat16 (the upper half of a binary32), and many tools
+ * want binary32 (float) values. We parse to these formats directly: going
+ * through a double would round twice, which is not always correct (e.g.,
+ * 1.000488281250000001 is just above the midpoint between two binary16
+ * values but rounds to it as a double).
+ *
+ * The conversion follows the one for binary64, with subnormals and exact
+ * midpoints handled in the fast path. For so few significant bits, the
+ * 128-bit truncated powers of five are always enough (Mushtak and Lemire,
+ * Fast number parsing without fallback, Software: Practice and Experience
+ * 53 (6), 2023). Only the narrow window of the power tables covering each
+ * format is ever accessed: about 500 bytes for binary16, 1.6 KB for
+ * bfloat16 and 1.6 KB for binary32.
+ */
+// The bit pattern of an IEEE binary16 value.
+struct binary16 {
+  uint16_t bits;
+};
+
+// The bit pattern of a bfloat16 value.
+struct bfloat16 {
+  uint16_t bits;
+};
+
+static_assert(sizeof(binary16) == 2 && sizeof(bfloat16) == 2,
+              "16-bit values should be packed");
+
+struct binary16_format {
+  static const int mantissa_bits = 10;
+  static const int minimum_exponent = -15;
+  static const int infinite_power = 0x1F;
+  // range of powers of ten for which w * 10^q might be exactly
+  // between two values (w < 2^64)
+  static const int min_exponent_round_to_even = -22;
+  static const int max_exponent_round_to_even = 5;
+  // same, between two subnormal values
+  static const int min_exponent_subnormal_round_to_even = -26;
+  static const int max_exponent_subnormal_round_to_even = -25;
+  // w * 10^q is zero below this range and infinite above it
+  static const int smallest_power_of_ten = -27;
+  static const int largest_power_of_ten = 4;
+};
+
+struct bfloat16_format {
+  static const int mantissa_bits = 7;
+  static const int minimum_exponent = -127;
+  static const int infinite_power = 0xFF;
+  static const int min_exponent_round_to_even = -24;
+  static const int max_exponent_round_to_even = 3;
+  // (empty: midpoints between subnormals need more than 64 bits)
+  static const int min_exponent_subnormal_round_to_even = 1;
+  static const int max_exponent_subnormal_round_to_even = 0;
+  static const int smallest_power_of_ten = -60;
+  static const int largest_power_of_ten = 38;
+};
+
+struct binary32_format {
+  static const int mantissa_bits = 23;
+  static const int minimum_exponent = -127;
+  static const int infinite_power = 0xFF;
+  static const int min_exponent_round_to_even = -17;
+  static const int max_exponent_round_to_even = 10;
+  // (empty: midpoints between subnormals need more than 64 bits)
+  static const int min_exponent_subnormal_round_to_even = 1;
+  static const int max_exponent_subnormal_round_to_even = 0;
+  static const int smallest_power_of_ten = -64;
+  static const int largest_power_of_ten = 38;
+};
+
+// A binary value mantissa * 2^(power2 + minimum_exponent), where power2 is
+// the biased exponent and mantissa excludes the implicit leading bit.
+struct adjusted_mantissa {
+  uint64_t mantissa;
+  int32_t power2;
+};
+
+// Computes w * 10^q, correctly rounded to the format, when w < 2^64 is
+// exact. An infinite result has power2 == format::infinite_power.
+template <typename format>
+really_inline adjusted_mantissa compute_float(int64_t q, uint64_t w) {
+  adjusted_mantissa answer;
+  if ((w == 0) || (q < format::smallest_power_of_ten)) {
+    answer.power2 = 0;
+    answer.mantissa = 0;
+    return answer;
+  }
+  if (q > format::largest_power_of_ten) {
+    answer.power2 = format::infinite_power;
+    answer.mantissa = 0;
+    return answer;
+  }
+  int lz = leading_zeroes(w);
+  w <<= lz;
+  value128 product =
+      compute_product_approximation<format::mantissa_bits + 3>(q, w);
+  int upperbit = int(product.high >> 63);
+  int shift = upperbit + 64 - format::mantissa_bits - 3;
+  answer.mantissa = product.high >> shift;
+  // see compute_float_64 for the derivation of the exponent
+  answer.power2 = int32_t((((152170 + 65536) * q) >> 16) + 63 + upperbit - lz -
+                          format::minimum_exponent);
+  if (answer.power2 <= 0) { // subnormal
+    if (-answer.power2 + 1 >= 64) {
+      answer.power2 = 0;
+      answer.mantissa = 0;
+      return answer;
+    }
+    int subnormal_shift = -answer.power2 + 1;
+    answer.mantissa >>= subnormal_shift;
+    // Midpoints between binary16 subnormals have short decimal expansions
+    // (e.g., 2^-25 = 2.98023223876953125e-8), so they need the same care.
+    if ((product.low <= 1) &&
+        (q >= format::min_exponent_subnormal_round_to_even) &&
+        (q <= format::max_exponent_subnormal_round_to_even) &&
+        ((answer.mantissa & 3) == 1) && (shift + subnormal_shift < 64) &&
+        ((answer.mantissa << (shift + subnormal_shift)) == product.high)) {
+      answer.mantissa &= ~uint64_t(1);
+    }
+    answer.mantissa += (answer.mantissa & 1);
+    answer.mantissa >>= 1;
+    // rounding up might give us the smallest normal value
+    answer.power2 =
+        (answer.mantissa < (uint64_t(1) << format::mantissa_bits)) ? 0 : 1;
+    return answer;
+  }
+  // We usually round up, but if we are right between two values, we
+  // round to even. This may only happen when 5^|q| fits in a word, and then
+  // the product is exact: all the bits we dropped must be zero.
+  if ((product.low <= 1) && (q >= format::min_exponent_round_to_even) &&
+      (q <= format::max_exponent_round_to_even) &&
+      ((answer.mantissa & 3) == 1)) {
+    if ((answer.mantissa << shift) == product.high) {
+      answer.mantissa &= ~uint64_t(1);
+    }
+  }
+  answer.mantissa += (answer.mantissa & 1);
+  answer.mantissa >>= 1;
+  if (answer.mantissa >= (uint64_t(2) << format::mantissa_bits)) {
+    answer.mantissa = (uint64_t(1) << format::mantissa_bits);
+    answer.power2++;
+  }
+  answer.mantissa &= ~(uint64_t(1) << format::mantissa_bits);
+  if (answer.power2 >= format::infinite_power) {
+    answer.power2 = format::infinite_power;
+    answer.mantissa = 0;
+  }
+  return answer;
+}
+
+// Rounds the absolute value of a finite double to the format. Ties go to
+// even when direction is 0, up when it is positive and down when it is
+// negative. Sets *midpoint when the value is right between two values of
+// the format.
+template <typename format>
+inline adjusted_mantissa round_binary64(double value, int direction,
+                                        bool *midpoint) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint64_t m = bits & ((uint64_t(1) << 52) - 1);
+  int e = int((bits >> 52) & 0x7FF);
+  if (e == 0) {
+    e = 1;
+  } else {
+    m |= uint64_t(1) << 52;
+  }
+  adjusted_mantissa answer;
+  answer.mantissa = 0;
+  answer.power2 = 0;
+  *midpoint = false;
+  if (m == 0) {
+    return answer;
+  }
+  // value = m * 2^(e - 1075) and its leading bit is at position top
+  int top = 63 - leading_zeroes(m);
+  int32_t biased = int32_t(e - 1075 + top - format::minimum_exponent);
+  int drop = top - format::mantissa_bits + (biased < 1 ? 1 - biased : 0);
+  if (drop >= 64) {
+    return answer; // less than half the smallest subnormal
+  }
+  uint64_t q = m >> drop;
+  uint64_t remainder = m & ((uint64_t(1) << drop) - 1);
+  uint64_t half = uint64_t(1) << (drop - 1);
+  *midpoint = (remainder == half);
+  if ((remainder > half) ||
+      ((remainder == half) && ((direction > 0) ||
+                               ((direction == 0) && (q & 1))))) {
+    q++;
+  }
+  if (biased < 1) {
+    answer.power2 = (q < (uint64_t(1) << format::mantissa_bits)) ? 0 : 1;
+    answer.mantissa = q & ((uint64_t(1) << format::mantissa_bits) - 1);
+    return answer;
+  }
+  if (q >= (uint64_t(2) << format::mantissa_bits)) {
+    q >>= 1;
+    biased++;
+  }
+  answer.power2 = biased;
+  answer.mantissa = q & ((uint64_t(1) << format::mantissa_bits) - 1);
+  if (answer.power2 >= format::infinite_power) {
+    answer.power2 = format::infinite_power;
+    answer.mantissa = 0;
+  }
+  return answer;
+}
+
+// Reads the significant digits of a decimal number and returns its
+// decimal exponent, such that the number is 0.digits * 10^exponent.
+inline int64_t significant_digits(const char *p, const char *end,
+                                  std::string *digits) {
+  int64_t exponent = 0;
+  bool seen_period = false;
+  digits->clear();
+  for (; (p != end) && (*p != 'e') && (*p != 'E'); p++) {
+    if (*p == '.') {
+      seen_period = true;
+    } else if (is_integer(*p)) {
+      if (digits->empty() && (*p == '0')) {
+        exponent -= seen_period ? 1 : 0; // leading zero
+      } else {
+        digits->push_back(*p);
+        exponent += seen_period ? 0 : 1;
+      }
+    }
+  }
+  if (p != end) { // exponent, saturated well beyond any finite value
+    p++;
+    bool negative = (*p == '-');
+    if ((*p == '-') || (*p == '+')) {
+      p++;
+    }
+    int64_t exp_number = 0;
+    for (; p != end; p++) {
+      if (exp_number < 0x100000000) {
+        exp_number = 10 * exp_number + (*p - '0');
+      }
+    }
+    exponent += negative ? -exp_number : exp_number;
+  }
+  while (!digits->empty() && (digits->back() == '0')) {
+    digits->pop_back();
+  }
+  return exponent;
+}
+
+// Compares the decimal number in [p, end), without its sign, to the
+// absolute value of value, a midpoint between two 16-bit or binary32
+// values.
+inline int compare_decimal(const char *p, const char *end, double value) {
+  if (*p == '-') {
+    p++;
+  }
+  std::string digits, value_digits;
+  int64_t exponent = significant_digits(p, end, &digits);
+  // We only compare with midpoints between 16-bit or binary32 values,
+  // m * 2^e with m < 2^25 and e >= -150, which have fewer than 120
+  // significant digits.
+  char buffer[160];
+  int written = snprintf(buffer, sizeof(buffer), "%.120e", std::fabs(value));
+  int64_t value_exponent =
+      significant_digits(buffer, buffer + written, &value_digits);
+  if (digits.empty()) {
+    return -1;
+  }
+  if (exponent != value_exponent) {
+    return exponent < value_exponent ? -1 : 1;
+  }
+  int c = digits.compare(value_digits);
+  return (c < 0) ? -1 : (c > 0 ? 1 : 0);
+}
+
+// Parses a number with 19 or more significant digits in [start, end): we
+// get the closest double from strtod and round it to the format, which is
+// only ambiguous if the double is right between two values of the format.
+template <typename format, typename UC>
+never_inline bool parse_many_digits(const UC *start, const UC *end,
+                                    adjusted_mantissa *answer) {
+  std::string number(start, end); // the scanner made sure it is ASCII
+  const char *number_end = number.data() + number.size();
+  double value;
+  if (parse_float_strtod(number.data(), number_end, &value) == nullptr) {
+    return false;
+  }
+  bool midpoint;
+  *answer = round_binary64<format>(value, 0, &midpoint);
+  if (midpoint) {
+    int c = compare_decimal(number.data(), number_end, value);
+    if (c != 0) {
+      *answer = round_binary64<format>(value, c, &midpoint);
+    }
+  }
+  return true;
+}
+
+template <typename format, typename UC, typename bits_type>
+really_inline const UC *parse_number_narrow(const UC *p, bits_type *bits) {
+  decimal_number number;
+  const UC *end = scan_number<false>(p, &number);
+  if (end == nullptr) {
+    return nullptr;
+  }
+  adjusted_mantissa answer;
+  if (unlikely(number.many_digits)) {
+    if (!parse_many_digits<format>(p, end, &answer)) {
+      return nullptr;
+    }
+  } else {
+    answer = compute_float<format>(number.exponent, number.significand);
+  }
+  // like binary64 values, values that do not fit are refused
+  if (answer.power2 == format::infinite_power) {
+    return nullptr;
+  }
+  *bits = bits_type(answer.mantissa |
+                    (uint64_t(answer.power2) << format::mantissa_bits) |
+                    (uint64_t(number.negative) << (8 * sizeof(bits_type) - 1)));
+  return end;
+}
+
+// parse the number at p as a binary16 value, correctly rounded
+// return the null pointer on error (including values too large for binary16)
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number(const UC *p,
+                                                 binary16 *outValue) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  return parse_number_narrow<binary16_format>(p, &outValue->bits);
+}
+
+// parse the number at p as a bfloat16 value, correctly rounded
+// return the null pointer on error (including values too large for bfloat16)
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number(const UC *p,
+                                                 bfloat16 *outValue) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  return parse_number_narrow<bfloat16_format>(p, &outValue->bits);
+}
+
+// parse the number at p as a float (binary32), correctly rounded
+// return the null pointer on error (including values too large for a float)
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number(const UC *p,
+                                                 float *outValue) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  static_assert(sizeof(float) == sizeof(uint32_t) &&
+                    std::numeric_limits<float>::is_iec559,
+                "float should be binary32");
+  uint32_t bits;
+  const UC *end = parse_number_narrow<binary32_format>(p, &bits);
+  if (end != nullptr) {
+    memcpy(outValue, &bits, sizeof(bits));
+  }
+  return end;
+}
+
+/**
+ * Lazy parsing.
+ *
+ * When only some of the numbers in a document are ever read, converting all
+ * of them up front is wasted work. Parsing a number into a lazy_double only
+ * checks its grammar and records its span along with what the conversion
+ * needs (significand, exponent, sign). The conversion runs the first time
+ * the value is read, and its result replaces the significand.
+ */
+class lazy_double {
+public:
+  lazy_double() : start(nullptr), payload(0), size(0), exponent(0), flags(0) {}
+
+  // The value of the number, converted on first access. Concurrent first
+  // accesses to the same number from several threads are not safe.
+  really_inline double value() const {
+    if (unlikely(!(flags & converted_flag))) {
+      convert();
+    }
+    double answer;
+    memcpy(&answer, &payload, sizeof(answer));
+    return answer;
+  }
+
+  // The span of the number in the input, which must outlive it.
+  const char *begin() const { return start; }
+  const char *end() const { return start + size; }
+  size_t length() const { return size; }
+
+  bool negative() const { return (flags & negative_flag) != 0; }
+  // true once the value has been computed
+  bool converted() const { return (flags & converted_flag) != 0; }
+
+private:
+  template <typename T>
+  friend void relocate(T *, const char *, const char *);
+  friend const char *parse_number(const char *p, lazy_double *outValue);
+
+  static const uint8_t negative_flag = 1;
+  static const uint8_t many_digits_flag = 2;
+  static const uint8_t converted_flag = 4;
+
+  never_inline void convert() const {
+    double answer;
+    bool success = false;
+    if (flags & many_digits_flag) {
+      // a saturated exponent cannot be adjusted for the dropped digits
+      success = (exponent > INT16_MIN) && (exponent < INT16_MAX) &&
+                compute_float_many_digits(begin(), end(), exponent,
+                                          negative(), &answer);
+    } else if ((exponent >= FASTFLOAT_SMALLEST_POWER) &&
+               (exponent <= FASTFLOAT_LARGEST_POWER)) {
+      success = true;
+      answer = compute_float_64(exponent, payload, negative(), &success);
+      // compute_float_64 only fails on numbers too large for a double, which
+      // get an infinity below
+    } else {
+      // zero, or too large (with an infinity), even if the exponent was
+      // saturated
+      compute_float_out_of_range(exponent, payload, negative(), &answer);
+      success = true;
+    }
+    if (!success && (flags & many_digits_flag)) {
+      // the span may not be followed by a readable byte
+      success = parse_float_strtod<char>(begin(), end(), &answer) != nullptr;
+    }
+    if (!success) {
+      // only numbers too large for a double get here
+      answer = negative() ? -std::numeric_limits<double>::infinity()
+                          : std::numeric_limits<double>::infinity();
+    }
+    memcpy(&payload, &answer, sizeof(payload));
+    flags |= converted_flag;
+  }
+
+  const char *start;
+  // the significand, then the bits of the value once converted
+  mutable uint64_t payload;
+  uint32_t size;
+  // saturated: anything beyond the tables goes through strtod
+  int16_t exponent;
+  mutable uint8_t flags;
+};
+
+// Moves the span of a number parsed from a copy back to the original input.
+template <typename T>
+really_inline void relocate(T *, const char *, const char *) {}
+
+template <>
+really_inline void relocate(lazy_double *value, const char *copy,
+                            const char *original) {
+  value->start = original + (value->start - copy);
+}
+
+// check the grammar of the number at p and record it into outValue, to be
+// converted later
+// return the end of the number, or the null pointer on error
+// Unlike parse_number(const char *, double *), numbers too large for a
+// double are accepted: their value is infinite.
+WARN_UNUSED
+inline const char *parse_number(const char *p, lazy_double *outValue) {
+  decimal_number number;
+  const char *end = scan_number<false>(p, &number);
+  if (end == nullptr) {
+    return nullptr;
+  }
+  outValue->start = p;
+  outValue->size = uint32_t(end - p);
+  outValue->payload = number.significand;
+  outValue->exponent =
+      int16_t(number.exponent < INT16_MIN
+                  ? INT16_MIN
+                  : (number.exponent > INT16_MAX ? INT16_MAX : number.exponent));
+  outValue->flags = uint8_t((number.negative ? lazy_double::negative_flag : 0) |
+                            (number.many_digits ? lazy_double::many_digits_flag
+                                                : 0));
+  return end;
+}
+
+/**
+ * Integers and floating-point numbers.
+ *
+ * Columns of JSON or CSV data mix integers and decimal numbers, and large
+ * integers (beyond 2^53) lose precision as doubles. Parsing into a
+ * tagged_number classifies the number in the same pass: following the JSON
+ * convention, a number without a fraction or an exponent is an integer if it
+ * fits in 64 bits.
+ */
+enum class number_type : uint8_t {
+  signed_integer,   // int64_value is valid
+  unsigned_integer, // uint64_value is valid: the value exceeds INT64_MAX
+  floating_point    // double_value is valid
+};
+
+struct tagged_number {
+  number_type type;
+  union {
+    int64_t int64_value;
+    uint64_t uint64_value;
+    double double_value;
+  };
+};
+
+// parse the number at p, as an integer when it has neither a fraction nor an
+// exponent and fits in 64 bits (as int64_t if possible), as a double
+// otherwise (including -0, which keeps its sign)
+// return the end of the number, or the null pointer on error
+template <typename UC>
+WARN_UNUSED really_inline const UC *parse_number(const UC *p,
+                                                 tagged_number *outValue) {
+  static_assert(is_supported_code_unit<UC>::value,
+                "unsupported code unit type");
+  decimal_number number;
+  const UC *end = scan_number<false>(p, &number);
+  if (end == nullptr) {
+    return nullptr;
+  }
+  if (number.integer) {
+    const uint64_t i = number.significand;
+    const size_t digit_count = size_t(end - p) - size_t(number.negative);
+    if (number.negative) {
+      // 19 digits cannot overflow, and -2^63 is the smallest int64_t
+      if ((digit_count <= 19) && (i != 0) &&
+          (i <= uint64_t(INT64_MAX) + 1)) {
+        outValue->type = number_type::signed_integer;
+        outValue->int64_value = int64_t(~i + 1);
+        return end;
+      }
+    } else if (digit_count <= 19) {
+      outValue->type = (i <= uint64_t(INT64_MAX))
+                           ? number_type::signed_integer
+                           : number_type::unsigned_integer;
+      outValue->uint64_value = i;
+      return end;
+    } else if ((digit_count == 20) && (p[0] == '1') &&
+               (i > uint64_t(INT64_MAX))) {
+      // A 20-digit number that fits in 64 bits starts with 1 and is at
+      // least 10^19 > INT64_MAX. If it did not fit, i wrapped around below
+      // 2 * 10^19 - 2^64 < INT64_MAX.
+      outValue->type = number_type::unsigned_integer;
+      outValue->uint64_value = i;
+      return end;
+    }
+  }
+  outValue->type = number_type::floating_point;
+  return compute_double(number, p, end, &outValue->double_value);
+}
+
+/**
+ * Bulk parsing.
+ *
+ * The bulk entry points parse many numbers out of a bounded buffer
+ * [begin, end) in one call. Numbers are separated by one or more white space
+ * characters (space, tab, line feed, carriage return) or commas. The buffer
+ * need not be null terminated.
+ *
+ * Skipping separators is done by a kernel specific to an instruction set. The
+ * kernel is chosen once, the first time it is needed, from what the CPU
+ * supports. It may be forced with force_instruction_set, which is mostly
+ * useful for testing and benchmarking every kernel on a single machine.
+ */
+enum class instruction_set : uint32_t {
+  automatic = 0, // best kernel supported by the current CPU
+  scalar = 1,
+  sse42 = 2,
+  avx2 = 4,
+  avx512 = 8,
+};
+
+static inline const char *instruction_set_name(instruction_set set) {
+  switch (set) {
+  case instruction_set::automatic:
+    return "automatic";
+  case instruction_set::scalar:
+    return "scalar";
+  case instruction_set::sse42:
+    return "sse42";
+  case instruction_set::avx2:
+    return "avx2";
+  case instruction_set::avx512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *eax,
+                  uint32_t *ebx, uint32_t *ecx, uint32_t *edx) {
+#ifdef _MSC_VER
+  int regs[4];
+  __cpuidex(regs, int(leaf), int(subleaf));
+  *eax = uint32_t(regs[0]);
+  *ebx = uint32_t(regs[1]);
+  *ecx = uint32_t(regs[2]);
+  *edx = uint32_t(regs[3]);
+#else
+  __asm__ volatile("cpuid"
+                   : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                   : "a"(leaf), "c"(subleaf));
+#endif // _MSC_VER
+}
+
+// Which register states the operating system saves on context switches.
+inline uint64_t xgetbv() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (uint64_t(edx) << 32) | eax;
+#endif // _MSC_VER
+}
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+
+// Returns the instruction sets supported by the current CPU and operating
+// system, as a bitset of instruction_set values.
+inline uint32_t detect_supported_instruction_sets() {
+  uint32_t supported = uint32_t(instruction_set::scalar);
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  uint32_t eax, ebx, ecx, edx;
+  cpuid(0, 0, &eax, &ebx, &ecx, &edx);
+  uint32_t max_leaf = eax;
+  if (max_leaf < 1) {
+    return supported;
+  }
+  cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+  if (ecx & (1u << 20)) {
+    supported |= uint32_t(instruction_set::sse42);
+  }
+  // AVX registers are only usable if the OS saves them (OSXSAVE + XCR0).
+  if (!(ecx & (1u << 27)) || (max_leaf < 7)) {
+    return supported;
+  }
+  uint64_t xcr0 = xgetbv();
+  cpuid(7, 0, &eax, &ebx, &ecx, &edx);
+  if (((xcr0 & 0x6) == 0x6) && (ebx & (1u << 5))) {
+    supported |= uint32_t(instruction_set::avx2);
+  }
+  // AVX-512 further needs the opmask and zmm states (XCR0 bits 5 to 7).
+  if (((xcr0 & 0xe6) == 0xe6) && (ebx & (1u << 16)) && (ebx & (1u << 30))) {
+    supported |= uint32_t(instruction_set::avx512);
+  }
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  return supported;
+}
+
+// Cached version of detect_supported_instruction_sets.
+inline uint32_t supported_instruction_sets() {
+  static const uint32_t supported = detect_supported_instruction_sets();
+  return supported;
+}
+
+inline instruction_set best_supported_instruction_set() {
+  uint32_t supported = supported_instruction_sets();
+  if (supported & uint32_t(instruction_set::avx512)) {
+    return instruction_set::avx512;
+  }
+  if (supported & uint32_t(instruction_set::avx2)) {
+    return instruction_set::avx2;
+  }
+  if (supported & uint32_t(instruction_set::sse42)) {
+    return instruction_set::sse42;
+  }
+  return instruction_set::scalar;
+}
+
+inline std::atomic<uint32_t> &active_instruction_set_slot() {
+  static std::atomic<uint32_t> slot{uint32_t(instruction_set::automatic)};
+  return slot;
+}
+
+// Returns the instruction set used by the bulk kernels.
+really_inline instruction_set active_instruction_set() {
+  uint32_t set = active_instruction_set_slot().load(std::memory_order_relaxed);
+  if (unlikely(set == uint32_t(instruction_set::automatic))) {
+    set = uint32_t(best_supported_instruction_set());
+    active_instruction_set_slot().store(set, std::memory_order_relaxed);
+  }
+  return instruction_set(set);
+}
+
+// Forces the bulk kernels to use the given instruction set, or goes back to
+// the best supported one with instruction_set::automatic. Returns false, and
+// changes nothing, if the CPU does not support the instruction set.
+inline bool force_instruction_set(instruction_set set) {
+  if (set != instruction_set::automatic &&
+      !(supported_instruction_sets() & uint32_t(set))) {
+    return false;
+  }
+  active_instruction_set_slot().store(uint32_t(set),
+                                      std::memory_order_relaxed);
+  return true;
+}
+
+static inline bool is_separator(char c) {
+  return (c == ' ') || (c == ',') || (c == '\n') || (c == '\r') ||
+         (c == '\t');
+}
+
+// Parses the number at p, in a buffer that ends at end when the byte at end
+// might not be readable, by copying [p, end) to a null-terminated buffer.
+// Returns where parse_number stops, at end or before, or the null pointer.
+template <typename T>
+never_inline const char *parse_number_prefix_copy(const char *p,
+                                                  const char *end,
+                                                  T *outValue) {
+  size_t length = size_t(end - p);
+  char small_buffer[64];
+  std::string large_buffer;
+  char *buffer = small_buffer;
+  if (length >= sizeof(small_buffer)) {
+    large_buffer.assign(p, length);
+    buffer = &large_buffer[0];
+  } else {
+    memcpy(buffer, p, length);
+    buffer[length] = '\0';
+  }
+  const char *buffer_end = parse_number(buffer, outValue);
+  if (buffer_end == nullptr) {
+    return nullptr;
+  }
+  relocate(outValue, buffer, p);
+  return p + (buffer_end - buffer);
+}
+
+// Parses the number in [p, end) when the byte at end might not be readable.
+// Returns the null pointer unless the whole range is a number.
+template <typename T>
+really_inline const char *parse_number_copy(const char *p, const char *end,
+                                            T *outValue) {
+  return (parse_number_prefix_copy(p, end, outValue) == end) ? end : nullptr;
+}
+
+struct scalar_kernel {
+  static really_inline const char *skip_separators(const char *p,
+                                                   const char *end) {
+    while ((p != end) && is_separator(*p)) {
+      p++;
+    }
+    return p;
+  }
+
+  // Bit i is set when p[i] is a separator, for the 64 bytes at p.
+  static really_inline uint64_t separator_mask(const char *p) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++) {
+      mask |= uint64_t(is_separator(p[i])) << i;
+    }
+    return mask;
+  }
+};
+
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+struct sse42_kernel {
+  FAST_DOUBLE_PARSER_TARGET("sse4.2")
+  static inline const char *skip_separators(const char *p, const char *end) {
+    // numbers are usually separated by one or two characters: vectors only
+    // pay off on longer runs
+    if ((end - p < 2) || !is_separator(p[0]) || !is_separator(p[1])) {
+      return scalar_kernel::skip_separators(p, end);
+    }
+    const __m128i separators = _mm_setr_epi8(' ', ',', '\n', '\r', '\t', 0, 0,
+                                             0, 0, 0, 0, 0, 0, 0, 0, 0);
+    while (end - p >= 16) {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+      // index of the first byte that is not a separator, 16 if none
+      int index = _mm_cmpestri(separators, 5, chunk, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                                   _SIDD_NEGATIVE_POLARITY);
+      if (index < 16) {
+        return p + index;
+      }
+      p += 16;
+    }
+    return scalar_kernel::skip_separators(p, end);
+  }
+
+  // The separators have distinct low nibbles, so that a single table lookup
+  // tells whether a byte is one of them. Bytes with the high bit set look up
+  // zero, which they cannot be equal to.
+  FAST_DOUBLE_PARSER_TARGET("sse4.2")
+  static inline uint64_t separator_mask(const char *p) {
+    const __m128i table = _mm_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t',
+                                        '\n', 0, ',', '\r', 0, 0);
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+      __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+      __m128i match = _mm_cmpeq_epi8(chunk, _mm_shuffle_epi8(table, chunk));
+      mask |= uint64_t(uint32_t(_mm_movemask_epi8(match))) << (16 * i);
+    }
+    return mask;
+  }
+};
+
+struct avx2_kernel {
+  FAST_DOUBLE_PARSER_TARGET("avx2")
+  static inline const char *skip_separators(const char *p, const char *end) {
+    if ((end - p < 2) || !is_separator(p[0]) || !is_separator(p[1])) {
+      return scalar_kernel::skip_separators(p, end);
+    }
+    while (end - p >= 32) {
+      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+      __m256i space = _mm256_or_si256(
+          _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+          _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')));
+      __m256i control = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')),
+                          _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))),
+          _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+      uint32_t others =
+          ~uint32_t(_mm256_movemask_epi8(_mm256_or_si256(space, control)));
+      if (others != 0) {
+        return p + trailing_zeroes(others);
+      }
+      p += 32;
+    }
+    return scalar_kernel::skip_separators(p, end);
+  }
+
+  // See sse42_kernel::separator_mask.
+  FAST_DOUBLE_PARSER_TARGET("avx2")
+  static inline uint64_t separator_mask(const char *p) {
+    const __m256i table = _mm256_setr_epi8(
+        ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, ',', '\r', 0, 0, ' ', 0, 0,
+        0, 0, 0, 0, 0, 0, '\t', '\n', 0, ',', '\r', 0, 0);
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i high =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+    uint32_t low_mask = uint32_t(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(low, _mm256_shuffle_epi8(table, low))));
+    uint32_t high_mask = uint32_t(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(high, _mm256_shuffle_epi8(table, high))));
+    return uint64_t(low_mask) | (uint64_t(high_mask) << 32);
+  }
+};
+
+struct avx512_kernel {
+  FAST_DOUBLE_PARSER_TARGET("avx512f,avx512bw")
+  static inline const char *skip_separators(const char *p, const char *end) {
+    if ((end - p < 2) || !is_separator(p[0]) || !is_separator(p[1])) {
+      return scalar_kernel::skip_separators(p, end);
+    }
+    while (end - p >= 64) {
+      __m512i chunk = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+      __mmask64 separators =
+          _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(' ')) |
+          _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(',')) |
+          _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\n')) |
+          _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\r')) |
+          _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\t'));
+      uint64_t others = ~uint64_t(separators);
+      if (others != 0) {
+        return p + trailing_zeroes(others);
+      }
+      p += 64;
+    }
+    return scalar_kernel::skip_separators(p, end);
+  }
+
+  // See sse42_kernel::separator_mask.
+  FAST_DOUBLE_PARSER_TARGET("avx512f,avx512bw")
+  static inline uint64_t separator_mask(const char *p) {
+    // the table of sse42_kernel::separator_mask, in 32-bit words
+    const __m512i table =
+        _mm512_set4_epi32(0x00000D2C, 0x000A0900, 0x00000000, 0x00000020);
+    __m512i chunk = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+    return _mm512_cmpeq_epi8_mask(chunk, _mm512_shuffle_epi8(table, chunk));
+  }
+};
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+
+// Finds the bounds of the numbers in [begin, end), 64 bytes at a time, as
+// stage 1 of simdjson does (see index_numbers). From the bitmap of the
+// separators in a block, a number starts where a separator is followed by
+// another byte, and ends where another byte is followed by a separator;
+// carries link the blocks. The bits are flattened into arrays of pointers,
+// the i-th end going with the i-th start, without a branch per byte.
+template <typename kernel> class structural_indexer {
+public:
+  // A block holds at most 32 starts and 32 ends.
+  static const size_t max_wanted = 32;
+
+  structural_indexer(const char *begin_, const char *end_)
+      : begin(begin_), end(end_), offset(0), start_count(0), end_count(0),
+        previous_separator(1), previous_other(0) {}
+
+  // Indexes blocks until wanted (at most max_wanted) numbers are complete,
+  // or up to the end of the buffer, and returns how many are complete.
+  // The last number may end at end, unterminated.
+  really_inline size_t fill(size_t wanted) {
+    while (end_count < wanted) {
+      if (!load()) {
+        if (start_count > end_count) {
+          ends[end_count++] = end;
+        }
+        break;
+      }
+    }
+    return end_count;
+  }
+
+  // The bounds [starts()[i], ends()[i]) of the complete numbers.
+  really_inline const char *const *number_starts() const { return starts; }
+  really_inline const char *const *number_ends() const { return ends; }
+
+  // Forgets the first n numbers.
+  really_inline void consume(size_t n) {
+    start_count -= n;
+    end_count -= n;
+    memmove(starts, starts + n, start_count * sizeof(starts[0]));
+    memmove(ends, ends + n, end_count * sizeof(ends[0]));
+  }
+
+  // The start of the next number, or end if there is none.
+  really_inline const char *next_start() {
+    while (start_count == 0) {
+      if (!load()) {
+        return end;
+      }
+    }
+    return starts[0];
+  }
+
+private:
+  // Classifies the next block, the last one padded with separators.
+  really_inline bool load() {
+    size_t size = size_t(end - begin);
+    if (offset >= size) {
+      return false;
+    }
+    const char *block = begin + offset;
+    uint64_t separators;
+    if (size - offset >= 64) {
+      separators = kernel::separator_mask(block);
+    } else {
+      char padded[64];
+      memset(padded, ' ', sizeof(padded));
+      memcpy(padded, block, size - offset);
+      separators = kernel::separator_mask(padded);
+    }
+    uint64_t others = ~separators;
+    uint64_t start_bits = others & ((separators << 1) | previous_separator);
+    uint64_t end_bits = separators & ((others << 1) | previous_other);
+    previous_separator = separators >> 63;
+    previous_other = others >> 63;
+    offset += 64;
+    while (start_bits != 0) {
+      starts[start_count++] = block + trailing_zeroes(start_bits);
+      start_bits &= start_bits - 1;
+    }
+    while (end_bits != 0) {
+      ends[end_count++] = block + trailing_zeroes(end_bits);
+      end_bits &= end_bits - 1;
+    }
+    return true;
+  }
+
+  const char *begin;
+  const char *end;
+  size_t offset; // of the next block
+  // fill stops with fewer than max_wanted complete numbers, and one more
+  // start, before adding a block
+  const char *starts[2 * max_wanted + 1];
+  const char *ends[2 * max_wanted + 1];
+  size_t start_count;
+  size_t end_count;
+  // whether the last byte of the previous block was a separator, or not
+  uint64_t previous_separator;
+  uint64_t previous_other;
+};
+
+template <typename kernel, typename T>
+really_inline const char *parse_numbers_loop(const char *begin,
+                                             const char *end, T *out,
+                                             size_t capacity, size_t *count) {
+  // Numbers that start before the last separator are followed by a readable
+  // byte, so parse_number can run on them directly. The final number, if
+  // the buffer does not end with a separator, is copied first.
+  const char *last_separator = end;
+  while ((last_separator != begin) && !is_separator(last_separator[-1])) {
+    last_separator--;
+  }
+  size_t written = 0;
+  const char *p = kernel::skip_separators(begin, end);
+  while (p != end) {
+    if (written == capacity) {
+      break;
+    }
+    const char *next;
+    if (p < last_separator) {
+      next = parse_number(p, out + written);
+      if ((next == nullptr) || !is_separator(*next)) {
+        break;
+      }
+    } else {
+      next = parse_number_copy(p, end, out + written);
+      if (next == nullptr) {
+        break;
+      }
+    }
+    written++;
+    p = kernel::skip_separators(next, end);
+  }
+  *count = written;
+  return p;
+}
+
+template <typename T>
+inline const char *parse_numbers_scalar(const char *begin, const char *end,
+                                        T *out, size_t capacity,
+                                        size_t *count) {
+  return parse_numbers_loop<scalar_kernel>(begin, end, out, capacity, count);
+}
+
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+template <typename T>
+FAST_DOUBLE_PARSER_TARGET("sse4.2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *parse_numbers_sse42(const char *begin, const char *end,
+                                       T *out, size_t capacity,
+                                       size_t *count) {
+  return parse_numbers_loop<sse42_kernel>(begin, end, out, capacity, count);
+}
+
+template <typename T>
+FAST_DOUBLE_PARSER_TARGET("avx2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *parse_numbers_avx2(const char *begin, const char *end,
+                                      T *out, size_t capacity,
+                                      size_t *count) {
+  return parse_numbers_loop<avx2_kernel>(begin, end, out, capacity, count);
+}
+
+template <typename T>
+FAST_DOUBLE_PARSER_TARGET("avx512f,avx512bw") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *parse_numbers_avx512(const char *begin, const char *end,
+                                        T *out, size_t capacity,
+                                        size_t *count) {
+  return parse_numbers_loop<avx512_kernel>(begin, end, out, capacity, count);
+}
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+
+template <typename T> struct parse_numbers_function {
+  typedef const char *(*type)(const char *, const char *, T *, size_t,
+                              size_t *);
+};
+
+template <typename T>
+inline typename parse_numbers_function<T>::type
+parse_numbers_kernel(instruction_set set) {
+  switch (set) {
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  case instruction_set::sse42:
+    return parse_numbers_sse42<T>;
+  case instruction_set::avx2:
+    return parse_numbers_avx2<T>;
+  case instruction_set::avx512:
+    return parse_numbers_avx512<T>;
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  default:
+    return parse_numbers_scalar<T>;
+  }
+}
+
+// Parses the numbers in [begin, end) into out, writing at most capacity
+// values, and stores the number of values written in *count.
+// Returns end if every number was parsed; otherwise returns the start of the
+// first number that could not be parsed or did not fit in out.
+// The values may be doubles, floats, or binary16 or bfloat16 values: arrays
+// of the latter are packed arrays of 16-bit patterns. They may also be lazy_double
+// values, pointing into [begin, end), or tagged_number values.
+template <typename T>
+WARN_UNUSED inline const char *parse_numbers(const char *begin,
+                                             const char *end, T *out,
+                                             size_t capacity, size_t *count) {
+  static_assert(std::is_same<T, double>::value ||
+                    std::is_same<T, float>::value ||
+                    std::is_same<T, binary16>::value ||
+                    std::is_same<T, bfloat16>::value ||
+                    std::is_same<T, lazy_double>::value ||
+                    std::is_same<T, tagged_number>::value,
+                "unsupported value type");
+  return parse_numbers_kernel<T>(active_instruction_set())(begin, end, out,
+                                                           capacity, count);
+}
+
+/**
+ * Number bounds.
+ *
+ * index_numbers finds where the numbers of a buffer start and end without
+ * parsing them, with the separator kernels: it classifies 64 bytes at a time
+ * into a bitmap and turns its transitions into pointers. Callers that split
+ * a buffer between threads, that only convert the numbers they need, or
+ * that map numbers to the fields of a CSV or JSON document get the bounds
+ * of every number at several gigabytes per second, then convert each one
+ * with parse_bounded_number. The grammar is checked in that second pass:
+ * the index treats any run of bytes other than separators as a number.
+ *
+ * parse_numbers does not use the index. Scanning a number already reads
+ * each of its bytes, so that finding its end first is extra work: on dense
+ * numbers, indexing then parsing is 5% to 20% slower than scanning each
+ * number and skipping the separators after it in one pass.
+ */
+template <typename kernel>
+really_inline const char *index_numbers_loop(const char *begin,
+                                             const char *end,
+                                             const char **starts,
+                                             const char **ends,
+                                             size_t capacity, size_t *count) {
+  structural_indexer<kernel> indexer(begin, end);
+  size_t found = 0;
+  while (found != capacity) {
+    size_t wanted = capacity - found;
+    if (wanted > structural_indexer<kernel>::max_wanted) {
+      wanted = structural_indexer<kernel>::max_wanted;
+    }
+    size_t complete = indexer.fill(wanted);
+    if (complete == 0) {
+      break;
+    }
+    if (complete > wanted) {
+      complete = wanted;
+    }
+    memcpy(starts + found, indexer.number_starts(),
+           complete * sizeof(starts[0]));
+    memcpy(ends + found, indexer.number_ends(), complete * sizeof(ends[0]));
+    indexer.consume(complete);
+    found += complete;
+  }
+  *count = found;
+  return indexer.next_start();
+}
+
+inline const char *index_numbers_scalar(const char *begin, const char *end,
+                                        const char **starts,
+                                        const char **ends, size_t capacity,
+                                        size_t *count) {
+  return index_numbers_loop<scalar_kernel>(begin, end, starts, ends, capacity,
+                                           count);
+}
+
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+FAST_DOUBLE_PARSER_TARGET("sse4.2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *index_numbers_sse42(const char *begin, const char *end,
+                                       const char **starts, const char **ends,
+                                       size_t capacity, size_t *count) {
+  return index_numbers_loop<sse42_kernel>(begin, end, starts, ends, capacity,
+                                          count);
+}
+
+FAST_DOUBLE_PARSER_TARGET("avx2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *index_numbers_avx2(const char *begin, const char *end,
+                                      const char **starts, const char **ends,
+                                      size_t capacity, size_t *count) {
+  return index_numbers_loop<avx2_kernel>(begin, end, starts, ends, capacity,
+                                         count);
+}
+
+FAST_DOUBLE_PARSER_TARGET("avx512f,avx512bw") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *index_numbers_avx512(const char *begin, const char *end,
+                                        const char **starts,
+                                        const char **ends, size_t capacity,
+                                        size_t *count) {
+  return index_numbers_loop<avx512_kernel>(begin, end, starts, ends, capacity,
+                                           count);
+}
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+
+typedef const char *(*index_numbers_function)(const char *, const char *,
+                                              const char **, const char **,
+                                              size_t, size_t *);
+
+inline index_numbers_function index_numbers_kernel(instruction_set set) {
+  switch (set) {
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  case instruction_set::sse42:
+    return index_numbers_sse42;
+  case instruction_set::avx2:
+    return index_numbers_avx2;
+  case instruction_set::avx512:
+    return index_numbers_avx512;
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  default:
+    return index_numbers_scalar;
+  }
+}
+
+// Finds the numbers in [begin, end): writes the start of each one to starts
+// and its end to ends, for at most capacity numbers, and stores how many
+// were found in *count. A number ends at a separator, or at end.
+// Returns end if every number was found; otherwise returns the start of the
+// first number that did not fit.
+WARN_UNUSED inline const char *index_numbers(const char *begin,
+                                             const char *end,
+                                             const char **starts,
+                                             const char **ends,
+                                             size_t capacity, size_t *count) {
+  return index_numbers_kernel(active_instruction_set())(begin, end, starts,
+                                                        ends, capacity, count);
+}
+
+// Parses the number [start, stop) found by index_numbers in a buffer that
+// ends at end. Returns stop, or the null pointer if [start, stop) is not a
+// number in full. As with parse_numbers, the value may be of any type that
+// parse_number supports.
+template <typename T>
+WARN_UNUSED really_inline const char *
+parse_bounded_number(const char *start, const char *stop, const char *end,
+                     T *outValue) {
+  if (unlikely(stop == end)) {
+    // the number is not followed by a readable byte
+    return parse_number_copy(start, end, outValue);
+  }
+  return (parse_number(start, outValue) == stop) ? stop : nullptr;
+}
+
+/**
+ * Reductions.
+ *
+ * Numbers are often parsed only to be aggregated. reduce_numbers parses a
+ * buffer like parse_numbers, but passes each value to a reducer instead of
+ * storing it, so that the values never make a round trip through memory. A
+ * reducer is any object with an add(double) method: number_summary and
+ * histogram are provided. Their merge methods combine the states of parts
+ * of a buffer, e.g., parsed by separate threads, into the state of the
+ * whole.
+ */
+
+// The count, extremes, sum, mean and variance of a sequence of values.
+// The sum is compensated (Neumaier's variant of Kahan summation) and the
+// mean and variance are updated as in Welford's method, so that neither
+// loses precision over long sequences.
+class number_summary {
+public:
+  number_summary()
+      : n(0), low(std::numeric_limits<double>::infinity()),
+        high(-std::numeric_limits<double>::infinity()), total(0),
+        compensation(0), running_mean(0), m2(0) {}
+
+  really_inline void add(double x) {
+    n++;
+    low = (x < low) ? x : low;
+    high = (x > high) ? x : high;
+    double t = total + x;
+    compensation +=
+        (std::fabs(total) >= std::fabs(x)) ? (total - t) + x : (x - t) + total;
+    total = t;
+    double delta = x - running_mean;
+    running_mean += delta / double(n);
+    m2 += delta * (x - running_mean);
+  }
+
+  // Adds the values summarized by other (Chan et al.'s update).
+  void merge(const number_summary &other) {
+    if (other.n == 0) {
+      return;
+    }
+    if (n == 0) {
+      *this = other;
+      return;
+    }
+    uint64_t merged = n + other.n;
+    double delta = other.running_mean - running_mean;
+    double weight = double(other.n) / double(merged);
+    running_mean += delta * weight;
+    m2 += other.m2 + delta * delta * double(n) * weight;
+    n = merged;
+    low = (other.low < low) ? other.low : low;
+    high = (other.high > high) ? other.high : high;
+    double t = total + other.total;
+    compensation += (std::fabs(total) >= std::fabs(other.total))
+                        ? (total - t) + other.total
+                        : (other.total - t) + total;
+    total = t;
+    compensation += other.compensation;
+  }
+
+  uint64_t count() const { return n; }
+  // infinity and minus infinity when there are no values
+  double minimum() const { return low; }
+  double maximum() const { return high; }
+  double sum() const { return total + compensation; }
+  // NaN when there are no values
+  double mean() const {
+    // the compensated sum is more accurate than the running mean
+    return (n == 0) ? std::numeric_limits<double>::quiet_NaN()
+                    : sum() / double(n);
+  }
+  // the population variance (divided by the count), NaN when there are no
+  // values
+  double variance() const {
+    return (n == 0) ? std::numeric_limits<double>::quiet_NaN()
+                    : m2 / double(n);
+  }
+  // the sample variance (divided by the count minus one), NaN when there
+  // are fewer than two values
+  double sample_variance() const {
+    return (n < 2) ? std::numeric_limits<double>::quiet_NaN()
+                   : m2 / double(n - 1);
+  }
+
+private:
+  uint64_t n;
+  double low;
+  double high;
+  double total;
+  double compensation;
+  double running_mean;
+  double m2; // the sum of the squared deviations from the mean
+};
+
+// Counts of values in bin_count bins of equal width over [low, high),
+// along with the values below low and those at or above high.
+class histogram {
+public:
+  histogram(double low_, double high_, size_t bin_count_)
+      : low(low_), high(high_),
+        scale(double(bin_count_ ? bin_count_ : 1) / (high_ - low_)),
+        bins(bin_count_ ? bin_count_ : 1, 0), below(0), above(0) {}
+
+  really_inline void add(double x) {
+    if (x < low) {
+      below++;
+    } else if (x >= high) {
+      above++;
+    } else {
+      size_t i = size_t((x - low) * scale);
+      // rounding may push values just below high out of the last bin
+      bins[(i < bins.size()) ? i : bins.size() - 1]++;
+    }
+  }
+
+  // Adds the counts of other. Returns false, without adding anything, if
+  // the bins of other differ.
+  WARN_UNUSED bool merge(const histogram &other) {
+    if ((other.low != low) || (other.high != high) ||
+        (other.bins.size() != bins.size())) {
+      return false;
+    }
+    for (size_t i = 0; i < bins.size(); i++) {
+      bins[i] += other.bins[i];
+    }
+    below += other.below;
+    above += other.above;
+    return true;
+  }
+
+  size_t bin_count() const { return bins.size(); }
+  uint64_t count(size_t bin) const { return bins[bin]; }
+  // the lower bound of a bin; bin_lower_bound(bin_count()) is high
+  double bin_lower_bound(size_t bin) const {
+    return (bin == bins.size()) ? high
+                                : low + (high - low) * double(bin) /
+                                            double(bins.size());
+  }
+  uint64_t underflow() const { return below; }
+  uint64_t overflow() const { return above; }
+
+private:
+  double low;
+  double high;
+  double scale; // bins per unit
+  std::vector<uint64_t> bins;
+  uint64_t below;
+  uint64_t above;
+};
+
+template <typename kernel, typename Reducer>
+really_inline const char *reduce_numbers_loop(const char *begin,
+                                              const char *end,
+                                              Reducer *reducer,
+                                              size_t *count) {
+  // as in parse_numbers_loop
+  const char *last_separator = end;
+  while ((last_separator != begin) && !is_separator(last_separator[-1])) {
+    last_separator--;
+  }
+  size_t added = 0;
+  const char *p = kernel::skip_separators(begin, end);
+  while (p != end) {
+    double x;
+    const char *next;
+    if (p < last_separator) {
+      next = parse_number(p, &x);
+      if ((next == nullptr) || !is_separator(*next)) {
+        break;
+      }
+    } else {
+      next = parse_number_copy(p, end, &x);
+      if (next == nullptr) {
+        break;
+      }
+    }
+    reducer->add(x);
+    added++;
+    p = kernel::skip_separators(next, end);
+  }
+  *count = added;
+  return p;
+}
+
+template <typename Reducer>
+inline const char *reduce_numbers_scalar(const char *begin, const char *end,
+                                         Reducer *reducer, size_t *count) {
+  return reduce_numbers_loop<scalar_kernel>(begin, end, reducer, count);
+}
+
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+template <typename Reducer>
+FAST_DOUBLE_PARSER_TARGET("sse4.2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *reduce_numbers_sse42(const char *begin, const char *end,
+                                        Reducer *reducer, size_t *count) {
+  return reduce_numbers_loop<sse42_kernel>(begin, end, reducer, count);
+}
+
+template <typename Reducer>
+FAST_DOUBLE_PARSER_TARGET("avx2") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *reduce_numbers_avx2(const char *begin, const char *end,
+                                       Reducer *reducer, size_t *count) {
+  return reduce_numbers_loop<avx2_kernel>(begin, end, reducer, count);
+}
+
+template <typename Reducer>
+FAST_DOUBLE_PARSER_TARGET("avx512f,avx512bw") FAST_DOUBLE_PARSER_FLATTEN
+inline const char *reduce_numbers_avx512(const char *begin, const char *end,
+                                         Reducer *reducer, size_t *count) {
+  return reduce_numbers_loop<avx512_kernel>(begin, end, reducer, count);
+}
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+
+template <typename Reducer> struct reduce_numbers_function {
+  typedef const char *(*type)(const char *, const char *, Reducer *,
+                              size_t *);
+};
+
+template <typename Reducer>
+inline typename reduce_numbers_function<Reducer>::type
+reduce_numbers_kernel(instruction_set set) {
+  switch (set) {
+#ifdef FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  case instruction_set::sse42:
+    return reduce_numbers_sse42<Reducer>;
+  case instruction_set::avx2:
+    return reduce_numbers_avx2<Reducer>;
+  case instruction_set::avx512:
+    return reduce_numbers_avx512<Reducer>;
+#endif // FAST_DOUBLE_PARSER_X86_64_DISPATCH
+  default:
+    return reduce_numbers_scalar<Reducer>;
+  }
+}
+
+// Parses the numbers in [begin, end) and passes their values, in order, to
+// reducer->add, and stores how many there were in *count.
+// Returns end if every number was parsed; otherwise returns the start of the
+// first number that could not be parsed, the values before it having been
+// added.
+template <typename Reducer>
+WARN_UNUSED inline const char *reduce_numbers(const char *begin,
+                                              const char *end,
+                                              Reducer *reducer,
+                                              size_t *count) {
+  return reduce_numbers_kernel<Reducer>(active_instruction_set())(
+      begin, end, reducer, count);
+}
+
+/**
+ * Streams of numbers of a single shape.
+ *
+ * Numbers from one source are often all written the same way: prices with
+ * two decimals, coordinates with six, "%.16e" output, counters. A
+ * stream_parser parses the buffers of such a stream like parse_numbers, but
+ * it first looks at the shape of the numbers. Once the first sample_size
+ * numbers all have the same shape, it switches to a loop made for that
+ * shape: it expects exactly the learned number of fraction digits, reads
+ * them eight at a time, and knows the decimal exponent up front. Any number
+ * that does not fit the shape goes through parse_number, so the results are
+ * always those of parse_numbers. After resample_after such numbers, the
+ * parser learns the shape again. When the sample mixes shapes, the rest of
+ * the stream goes to parse_numbers until the parser is reset.
+ */
+// Loads eight bytes as a little-endian word.
+really_inline uint64_t load_little_endian_64(const char *p) {
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+// Whether the eight bytes of a little-endian word are ASCII digits.
+really_inline bool is_made_of_eight_digits(uint64_t word) {
+  return ((word & 0xF0F0F0F0F0F0F0F0) |
+          (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+// The value of eight ASCII digits in a little-endian word, the first digit
+// in the least significant byte, in three multiplications.
+really_inline uint32_t parse_eight_digits(uint64_t word) {
+  const uint64_t mask = 0x000000FF000000FF;
+  const uint64_t mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+  const uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+  word -= 0x3030303030303030;
+  word = (word * 10) + (word >> 8);
+  word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+  return uint32_t(word);
+}
+
+// Whether c cannot continue a number.
+really_inline bool ends_number(char c) {
+  return !is_integer(c) && (c != '.') && (c != 'e') && (c != 'E');
+}
+
+class stream_parser {
+public:
+  enum class shape : uint8_t {
+    unknown,    // still sampling
+    generic,    // mixed shapes: parse_numbers
+    integer,    // -?[0-9]+ (at most 19 digits)
+    fixed,      // -?[0-9]+\.[0-9]{F}, with at most 19 digits
+    scientific, // -?[0-9]\.[0-9]{F}[eE][+-]?[0-9]{1,3}, with F <= 18
+  };
+
+  static const uint32_t sample_size = 16;
+  static const uint32_t resample_after = 16;
+
+  stream_parser() { reset(); }
+
+  // Forgets the shape: the next numbers are sampled again.
+  void reset() {
+    current = shape::unknown;
+    candidate = shape::unknown;
+    fraction_digits = 0;
+    candidate_digits = 0;
+    scale = 1;
+    tail_scale = 1;
+    sampled = 0;
+    misses = 0;
+    miss_count = 0;
+  }
+
+  // Parses the numbers in [begin, end) into out, like parse_numbers: writes
+  // at most capacity values, stores the number of values written in *count,
+  // and returns end if every number was parsed, otherwise the start of the
+  // first number that could not be parsed or did not fit in out.
+  WARN_UNUSED inline const char *parse_numbers(const char *begin,
+                                               const char *end, double *out,
+                                               size_t capacity,
+                                               size_t *count);
+
+  shape current_shape() const { return current; }
+  // the number of fraction digits of the fixed and scientific shapes
+  int current_fraction_digits() const { return fraction_digits; }
+  // how many numbers did not fit the learned shape
+  uint64_t mismatches() const { return miss_count; }
+
+private:
+  // -?[0-9]+ with a leading zero only when alone, and with n digits
+  really_inline static const char *scan_integer_part(const char *p,
+                                                     uint64_t *i, int *n) {
+    const char *start = p;
+    uint64_t value = 0;
+    while (is_integer(*p)) {
+      value = 10 * value + uint64_t(*p - '0');
+      p++;
+    }
+    *i = value;
+    *n = int(p - start);
+    if ((*n == 0) || ((*start == '0') && (*n > 1))) {
+      return nullptr;
+    }
+    return p;
+  }
+
+  // Exactly fraction_digits digits at p, appended to *i. With 24 bytes left
+  // in the buffer, they are read eight at a time.
+  really_inline const char *scan_fraction(const char *p, const char *end,
+                                          uint64_t *i) const {
+    uint64_t value = *i;
+    if (end - p >= 24) {
+      int left = fraction_digits;
+      for (; left >= 8; left -= 8) {
+        uint64_t word = load_little_endian_64(p);
+        if (!is_made_of_eight_digits(word)) {
+          return nullptr;
+        }
+        value = value * 100000000 + parse_eight_digits(word);
+        p += 8;
+      }
+      if (left > 0) {
+        // the last digits, after as many leading zeros as needed
+        const int shift = 8 * (8 - left);
+        uint64_t word = (load_little_endian_64(p) << shift) |
+                        (0x3030303030303030 >> (64 - shift));
+        if (!is_made_of_eight_digits(word)) {
+          return nullptr;
+        }
+        value = value * tail_scale + parse_eight_digits(word);
+        p += left;
+      }
+    } else {
+      for (int k = 0; k < fraction_digits; k++) {
+        if (!is_integer(p[k])) {
+          return nullptr;
+        }
+        value = 10 * value + uint64_t(p[k] - '0');
+      }
+      p += fraction_digits;
+    }
+    *i = value;
+    return p;
+  }
+
+  really_inline const char *scan_integer(const char *p, const char *,
+                                         double *outDouble) const {
+    bool negative = (*p == '-');
+    uint64_t i;
+    int n;
+    const char *q = scan_integer_part(p + negative, &i, &n);
+    if ((q == nullptr) || (n > 19) || !ends_number(*q)) {
+      return nullptr;
+    }
+    if (i <= 9007199254740991) {
+      double d = double(i);
+      *outDouble = negative ? -d : d;
+      return q;
+    }
+    bool success = true;
+    *outDouble = compute_float_64(0, i, negative, &success);
+    return q;
+  }
+
+  really_inline const char *scan_fixed(const char *p, const char *end,
+                                       double *outDouble) const {
+    bool negative = (*p == '-');
+    uint64_t i;
+    int n;
+    const char *q = scan_integer_part(p + negative, &i, &n);
+    if ((q == nullptr) || (n + fraction_digits > 19) || (*q != '.')) {
+      return nullptr;
+    }
+    q = scan_fraction(q + 1, end, &i);
+    if ((q == nullptr) || !ends_number(*q)) {
+      return nullptr;
+    }
+#if (FLT_EVAL_METHOD == 1) || (FLT_EVAL_METHOD == 0)
+    // the Clinger fast path, with the power of ten at hand
+    if (i <= 9007199254740991) {
+      double d = double(i) / scale;
+      *outDouble = negative ? -d : d;
+      return q;
+    }
+#endif
+    // at most 19 digits: never too large
+    bool success = true;
+    *outDouble = compute_float_64(-fraction_digits, i, negative, &success);
+    return q;
+  }
+
+  really_inline const char *scan_scientific(const char *p, const char *end,
+                                            double *outDouble) const {
+    bool negative = (*p == '-');
+    const char *q = p + negative;
+    if (!is_integer(q[0]) || (q[1] != '.')) {
+      return nullptr;
+    }
+    uint64_t i = uint64_t(q[0] - '0');
+    q = scan_fraction(q + 2, end, &i);
+    if ((q == nullptr) || ((*q != 'e') && (*q != 'E'))) {
+      return nullptr;
+    }
+    q++;
+    bool negative_exponent = (*q == '-');
+    q += (*q == '-') || (*q == '+');
+    if (!is_integer(*q)) {
+      return nullptr;
+    }
+    int64_t exponent = *q - '0';
+    q++;
+    if (is_integer(*q)) {
+      exponent = 10 * exponent + (*q - '0');
+      q++;
+      if (is_integer(*q)) {
+        exponent = 10 * exponent + (*q - '0');
+        q++;
+      }
+    }
+    if (!ends_number(*q)) {
+      return nullptr;
+    }
+    exponent = (negative_exponent ? -exponent : exponent) - fraction_digits;
+    if ((exponent < FASTFLOAT_SMALLEST_POWER) ||
+        (exponent > FASTFLOAT_LARGEST_POWER)) {
+      return nullptr;
+    }
+    bool success = true;
+    double d = compute_float_64(exponent, i, negative, &success);
+    if (!success) {
+      return nullptr;
+    }
+    *outDouble = d;
+    return q;
+  }
+
+  // The shape of the number [p, end), which parse_number accepted.
+  static shape shape_of(const char *p, const char *end, int *digits) {
+    p += (*p == '-');
+    const char *period = p;
+    while ((period != end) && (*period != '.')) {
+      period++;
+    }
+    const char *e = p;
+    while ((e != end) && (*e != 'e') && (*e != 'E')) {
+      e++;
+    }
+    if ((period == end) && (e == end)) {
+      return (end - p <= 19) ? shape::integer : shape::generic;
+    }
+    if (period == end) {
+      return shape::generic;
+    }
+    *digits = int(e - period - 1);
+    if (e == end) {
+      return (end - p - 1 <= 19) ? shape::fixed : shape::generic;
+    }
+    // at most three exponent digits, after an optional sign
+    const char *exponent_digits = e + 1 + ((e[1] == '-') || (e[1] == '+'));
+    if ((period == p + 1) && (*digits <= 18) && (end - exponent_digits <= 3)) {
+      return shape::scientific;
+    }
+    return shape::generic;
+  }
+
+  // Records the shape of a number parsed while sampling.
+  void sample(const char *p, const char *end) {
+    int digits = 0;
+    shape s = shape_of(p, end, &digits);
+    if (sampled == 0) {
+      candidate = s;
+      candidate_digits = digits;
+    } else if ((s != candidate) || (digits != candidate_digits)) {
+      candidate = shape::generic;
+    }
+    sampled++;
+    if ((candidate == shape::generic) || (sampled == sample_size)) {
+      current = candidate;
+      fraction_digits = candidate_digits;
+      scale = 1;
+      tail_scale = 1;
+      for (int k = 0; k < fraction_digits; k++) {
+        scale *= 10; // exact up to 10^22
+      }
+      for (int k = 0; k < fraction_digits % 8; k++) {
+        tail_scale *= 10;
+      }
+      misses = 0;
+    }
+  }
+
+  // Counts a number that did not fit the shape.
+  void miss() {
+    miss_count++;
+    if (++misses == resample_after) {
+      current = shape::unknown;
+      sampled = 0;
+    }
+  }
+
+  // Parses the numbers that start before last_separator with the scanner
+  // of the learned shape, until the shape is to be learned again. Updates
+  // *written and returns where it stopped; *failed is set when it stopped
+  // at a number that could not be parsed.
+  template <shape learned>
+  really_inline const char *parse_shape(const char *p,
+                                        const char *last_separator,
+                                        const char *end, double *out,
+                                        size_t capacity, size_t *written,
+                                        bool *failed) {
+    size_t w = *written;
+    while ((p < last_separator) && (w != capacity)) {
+      const char *next;
+      next = (learned == shape::integer)   ? scan_integer(p, end, out + w)
+             : (learned == shape::fixed)   ? scan_fixed(p, end, out + w)
+                                           : scan_scientific(p, end, out + w);
+      if (unlikely((next == nullptr) || !is_separator(*next))) {
+        next = fast_double_parser::parse_number(p, out + w);
+        if ((next == nullptr) || !is_separator(*next)) {
+          *failed = true;
+          break;
+        }
+        miss();
+        if (current != learned) {
+          w++;
+          p = scalar_kernel::skip_separators(next, end);
+          break;
+        }
+      }
+      w++;
+      p = scalar_kernel::skip_separators(next, end);
+    }
+    *written = w;
+    return p;
+  }
+
+  shape current;
+  shape candidate;
+  int fraction_digits;
+  int candidate_digits;
+  // 10^fraction_digits, and 10^(fraction_digits % 8)
+  double scale;
+  uint64_t tail_scale;
+  uint32_t sampled;
+  // since the shape was learned
+  uint32_t misses;
+  uint64_t miss_count;
+};
+
+inline const char *stream_parser::parse_numbers(const char *begin,
+                                                const char *end, double *out,
+                                                size_t capacity,
+                                                size_t *count) {
+  const char *last_separator = end;
+  while ((last_separator != begin) && !is_separator(last_separator[-1])) {
+    last_separator--;
+  }
+  size_t written = 0;
+  bool failed = false;
+  const char *p = scalar_kernel::skip_separators(begin, end);
+  while ((p != end) && (written != capacity) && !failed) {
+    if (p >= last_separator) {
+      // the final number, which the buffer does not terminate
+      const char *next = parse_number_copy(p, end, out + written);
+      if (next == nullptr) {
+        break;
+      }
+      written++;
+      p = scalar_kernel::skip_separators(next, end);
+      continue;
+    }
+    switch (current) {
+    case shape::integer:
+      p = parse_shape<shape::integer>(p, last_separator, end, out, capacity,
+                                      &written, &failed);
+      break;
+    case shape::fixed:
+      p = parse_shape<shape::fixed>(p, last_separator, end, out, capacity,
+                                    &written, &failed);
+      break;
+    case shape::scientific:
+      p = parse_shape<shape::scientific>(p, last_separator, end, out,
+                                         capacity, &written, &failed);
+      break;
+    case shape::generic: {
+      size_t n;
+      p = fast_double_parser::parse_numbers(p, end, out + written,
+                                            capacity - written, &n);
+      *count = written + n;
+      return p;
+    }
+    default: {
+      const char *next = fast_double_parser::parse_number(p, out + written);
+      if ((next == nullptr) || !is_separator(*next)) {
+        failed = true;
+        break;
+      }
+      sample(p, next);
+      written++;
+      p = scalar_kernel::skip_separators(next, end);
+      break;
+    }
+    }
+  }
+  *count = written;
+  return p;
+}
+
+/**
+ * Numbers of a known fixed format.
+ *
+ * Much data is printed with a fixed number of decimals: "%.2f" for prices,
+ * "%.6f" (the output of std::to_string) for measures. When the format is
+ * known at compile time, parse_fixed<IntDigitsMax, FracDigits> expects
+ * -?[0-9]{1,IntDigitsMax}\.[0-9]{FracDigits} (with no period when
+ * FracDigits is 0). Its digit loops are unrolled, the decimal exponent is
+ * the constant -FracDigits and, for significands of at most 53 bits, the
+ * value takes a single division by an exact power of ten. This is what the
+ * stream parser learns at run time for its fixed shape. Any number of
+ * another shape goes through parse_number, so that the results are always
+ * those of parse_number.
+ */
+// 10^n, for n <= 19, as a compile-time constant.
+template <int n> struct power_of_ten_64 {
+  static const uint64_t value = 10 * power_of_ten_64<n - 1>::value;
+};
+template <> struct power_of_ten_64<0> {
+  static const uint64_t value = 1;
+};
+
+// Adds the n digits at p to *fraction, each weighted by its power of ten so
+// that the products do not depend on each other. The recursion unrolls the
+// digits whatever the optimization level.
+template <int n> struct fraction_digits {
+  really_inline static bool add(const char *p, uint64_t *fraction) {
+    if (!is_integer(*p)) {
+      return false;
+    }
+    *fraction += uint64_t(*p - '0') * power_of_ten_64<n - 1>::value;
+    return fraction_digits<n - 1>::add(p + 1, fraction);
+  }
+};
+template <> struct fraction_digits<0> {
+  really_inline static bool add(const char *, uint64_t *) { return true; }
+};
+
+// Scans -?[0-9]{1,IntDigitsMax}\.[0-9]{FracDigits} at p and returns its
+// end, or the null pointer if the number at p has another shape. When wide
+// is true, the fraction digits are read eight at a time, which reads up to
+// fixed_format_bytes(IntDigitsMax, FracDigits) bytes from p.
+template <int IntDigitsMax, int FracDigits, bool wide>
+really_inline const char *scan_fixed_format(const char *p, uint64_t *i,
+                                            bool *negative) {
+  static_assert((IntDigitsMax >= 1) && (FracDigits >= 0) &&
+                    (IntDigitsMax + FracDigits <= 19),
+                "a fixed format has at most 19 digits");
+  *negative = (*p == '-');
+  p += *negative;
+  const char *start = p;
+  if (!is_integer(*p)) {
+    return nullptr;
+  }
+  uint64_t value = uint64_t(*p - '0');
+  p++;
+  for (int k = 1; k < IntDigitsMax; k++) {
+    if (!is_integer(*p)) {
+      break;
+    }
+    value = 10 * value + uint64_t(*p - '0');
+    p++;
+  }
+  // too many digits, or a leading zero that is not alone
+  if (is_integer(*p) || ((*start == '0') && (p - start > 1))) {
+    return nullptr;
+  }
+  if (FracDigits > 0) {
+    if (*p != '.') {
+      return nullptr;
+    }
+    p++;
+    if (wide) {
+      // the loop has at most two iterations
+      for (int k = 0; k < FracDigits / 8; k++) {
+        uint64_t word = load_little_endian_64(p);
+        if (!is_made_of_eight_digits(word)) {
+          return nullptr;
+        }
+        value = value * 100000000 + parse_eight_digits(word);
+        p += 8;
+      }
+      const int tail = FracDigits % 8;
+      if (tail > 0) {
+        // the last digits, after as many leading zeros as needed
+        const int shift = 8 * ((8 - tail) % 8);
+        uint64_t word = (load_little_endian_64(p) << shift) |
+                        (0x3030303030303030 & ((uint64_t(1) << shift) - 1));
+        if (!is_made_of_eight_digits(word)) {
+          return nullptr;
+        }
+        value = value * power_of_ten_64<tail>::value +
+                parse_eight_digits(word);
+        p += tail;
+      }
+    } else {
+      uint64_t fraction = 0;
+      if (!fraction_digits<FracDigits>::add(p, &fraction)) {
+        return nullptr;
+      }
+      value = value * power_of_ten_64<FracDigits>::value + fraction;
+      p += FracDigits;
+    }
+  }
+  if (!ends_number(*p)) {
+    return nullptr;
+  }
+  *i = value;
+  return p;
+}
+
+// The bytes that scan_fixed_format reads when wide: a sign, the integer
+// digits and the byte after them, then the fraction in words of eight and,
+// when the last word is full, the byte after it.
+constexpr int fixed_format_bytes(int int_digits_max, int frac_digits) {
+  return 2 + int_digits_max + 8 * ((frac_digits + 7) / 8) +
+         (((frac_digits > 0) && (frac_digits % 8 == 0)) ? 1 : 0);
+}
+
+template <int FracDigits>
+really_inline double fixed_format_value(uint64_t i, bool negative,
+                                        int max_digits) {
+#if (FLT_EVAL_METHOD == 1) || (FLT_EVAL_METHOD == 0)
+  // the Clinger fast path, with a constant power of ten
+  if ((max_digits <= 15) || (i <= 9007199254740991)) {
+    double d = double(i) / double(power_of_ten_64<FracDigits>::value);
+    return negative ? -d : d;
+  }
+#else
+  (void)max_digits;
+#endif
+  // at most 19 digits: never too large
+  bool success = true;
+  return compute_float_64(-FracDigits, i, negative, &success);
+}
+
+// Parses the number at p, expected in the fixed format with at most
+// IntDigitsMax integer digits and exactly FracDigits fraction digits, and
+// returns its end, or the null pointer on error, like parse_number.
+template <int IntDigitsMax, int FracDigits>
+WARN_UNUSED really_inline const char *parse_fixed(const char *p,
+                                                  double *outDouble) {
+  uint64_t i;
+  bool negative;
+  const char *end =
+      scan_fixed_format<IntDigitsMax, FracDigits, false>(p, &i, &negative);
+  if (unlikely(end == nullptr)) {
+    return parse_number(p, outDouble);
+  }
+  *outDouble = fixed_format_value<FracDigits>(i, negative,
+                                              IntDigitsMax + FracDigits);
+  return end;
+}
+
+// Parses the number at p in a buffer that ends at end, and need not be
+// terminated, with parse_number: the number ends where parse_number would
+// stop if the buffer were terminated, whatever follows it.
+template <typename T>
+never_inline const char *parse_number_before(const char *p, const char *end,
+                                             T *outValue) {
+  const char *q = p;
+  while ((q != end) &&
+         (!ends_number(*q) || (*q == '-') || (*q == '+'))) {
+    q++;
+  }
+  if (q != end) {
+    // parse_number stops at q, at the latest
+    return parse_number(p, outValue);
+  }
+  return parse_number_prefix_copy(p, end, outValue);
+}
+
+// Same as above, for a number at p in a buffer that ends at end (which
+// need not be terminated): away from the end of the buffer, the fraction
+// digits are read eight at a time.
+template <int IntDigitsMax, int FracDigits>
+WARN_UNUSED really_inline const char *
+parse_fixed(const char *p, const char *end, double *outDouble) {
+  if (end - p >= fixed_format_bytes(IntDigitsMax, FracDigits)) {
+    uint64_t i;
+    bool negative;
+    const char *number_end =
+        scan_fixed_format<IntDigitsMax, FracDigits, true>(p, &i, &negative);
+    if (number_end != nullptr) {
+      *outDouble = fixed_format_value<FracDigits>(i, negative,
+                                                  IntDigitsMax + FracDigits);
+      return number_end;
+    }
+  }
+  return parse_number_before(p, end, outDouble);
+}
+
+/**
+ * Column parsing.
+ *
+ * parse_column converts a column of strings stored as in Apache Arrow (an
+ * array of length + 1 offsets into a character buffer, row i being
+ * [data + offsets[i], data + offsets[i + 1])) into a column of values.
+ * Validity bitmaps follow the Arrow layout as well: bit i % 8 of byte i / 8
+ * is set when row i is valid.
+ *
+ * Rows are parsed 64 at a time: a block whose rows are all null costs
+ * nothing, and in other blocks we only visit the valid rows by iterating
+ * over the set bits of the bitmap, so there is no branch per null row.
+ */
+// Parses the row [p, end), which is not null terminated, knowing that
+// bytes up to data_end may be read.
+template <typename T>
+really_inline bool parse_row(const char *p, const char *end,
+                             const char *data_end, T *outValue) {
+  // Short rows are copied, with a fixed-size copy when possible, to a
+  // buffer where we can terminate them.
+  const size_t window = 32;
+  size_t length = size_t(end - p);
+  if (length < window) {
+    char buffer[window + 1];
+    if (size_t(data_end - p) >= window) {
+      memcpy(buffer, p, window);
+    } else {
+      memcpy(buffer, p, length);
+    }
+    buffer[length] = '\0';
+    return parse_number(buffer, outValue) == buffer + length;
+  }
+  return parse_number_copy(p, end, outValue) != nullptr;
+}
+
+// Loads the 64 bits of a bitmap starting at row `row`, of which only the
+// bits for the first `rows` rows are kept.
+really_inline uint64_t load_bitmap_word(const uint8_t *bitmap, size_t row,
+                                        size_t rows) {
+  uint64_t word = 0;
+  if (rows == 64) {
+    memcpy(&word, bitmap + row / 8, sizeof(word));
+    return word; // assumes a little-endian system, like Arrow
+  }
+  for (size_t i = 0; i < (rows + 7) / 8; i++) {
+    word |= uint64_t(bitmap[row / 8 + i]) << (8 * i);
+  }
+  return word & ((uint64_t(1) << rows) - 1);
+}
+
+really_inline void store_bitmap_word(uint8_t *bitmap, size_t row, size_t rows,
+                                     uint64_t word) {
+  if (rows == 64) {
+    memcpy(bitmap + row / 8, &word, sizeof(word));
+    return;
+  }
+  for (size_t i = 0; i < (rows + 7) / 8; i++) {
+    bitmap[row / 8 + i] = uint8_t(word >> (8 * i));
+  }
+}
+
+// Parses the length rows of a column of strings given by offsets (of type
+// int32_t, as in Arrow's StringArray, or int64_t, as in LargeStringArray)
+// and data into out, which must have room for length values.
+// input_validity may be the null pointer if no row is null. On return,
+// output_validity ((length + 7) / 8 bytes) has a bit set for every row that
+// was valid and parsed. Invalid rows get a value of zero.
+// Returns the number of rows that were valid but could not be parsed.
+template <typename offset_type, typename T>
+inline size_t parse_column(const offset_type *offsets, const char *data,
+                           size_t length, const uint8_t *input_validity,
+                           T *out, uint8_t *output_validity) {
+  static_assert(std::is_same<offset_type, int32_t>::value ||
+                    std::is_same<offset_type, int64_t>::value,
+                "offsets should be 32-bit or 64-bit signed integers");
+  static_assert(std::is_same<T, double>::value ||
+                    std::is_same<T, float>::value ||
+                    std::is_same<T, binary16>::value ||
+                    std::is_same<T, bfloat16>::value,
+                "unsupported value type");
+  const char *data_end = data + offsets[length];
+  size_t failures = 0;
+  for (size_t block = 0; block < length; block += 64) {
+    size_t rows = (length - block < 64) ? length - block : 64;
+    uint64_t valid = (rows == 64) ? ~uint64_t(0)
+                                  : ((uint64_t(1) << rows) - 1);
+    if (input_validity != nullptr) {
+      valid = load_bitmap_word(input_validity, block, rows);
+    }
+    memset(static_cast<void *>(out + block), 0, rows * sizeof(T));
+    uint64_t parsed = 0;
+    for (uint64_t remaining = valid; remaining != 0;
+         remaining &= remaining - 1) {
+      size_t i = block + size_t(trailing_zeroes(remaining));
+      bool ok = parse_row(data + offsets[i], data + offsets[i + 1], data_end,
+                          out + i);
+      parsed |= uint64_t(ok) << (i - block);
+      failures += size_t(!ok);
+    }
+    for (uint64_t remaining = valid & ~parsed; remaining != 0;
+         remaining &= remaining - 1) {
+      // a row may fail after writing a value
+      memset(static_cast<void *>(out + block + trailing_zeroes(remaining)), 0,
+             sizeof(T));
+    }
+    store_bitmap_word(output_validity, block, rows, parsed);
+  }
+  return failures;
 }
 
 } // namespace fast_double_parser
@@ -0,0 +1,24 @@
+# Generates benchmarks/data/subnormals.txt: one number per line, mostly
+# subnormal doubles and normal doubles just above 2^-1022, printed with
+# the shortest representation that round-trips.
+#
+# usage: python3 script/subnormal_generation.py > benchmarks/data/subnormals.txt
+import random
+import struct
+
+random.seed(1234)
+
+def from_bits(bits):
+    return struct.unpack("<d", struct.pack("<Q", bits))[0]
+
+for i in range(100000):
+    if i % 4 == 3:
+        # normal, with a biased exponent between 1 and 32 (about 1e-308)
+        bits = (random.randint(1, 32) << 52) | random.getrandbits(52)
+    else:
+        bits = random.getrandbits(52)
+        # some subnormals with few significant bits
+        bits >>= random.choice([0, 0, 0, 8, 24, 40])
+        if bits == 0:
+            bits = 1
+    print(repr(from_bits(bits)))
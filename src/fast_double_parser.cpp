@@ -0,0 +1,25 @@
+// The out-of-line part of fast_double_parser, for builds with
+// FAST_DOUBLE_PARSER_COMPILED_LIBRARY (the CMake option
+// FAST_DOUBLE_PARSER_COMPILED): the tables of powers of five, the general
+// conversion and the fallbacks, which the header declares extern.
+#ifndef FAST_DOUBLE_PARSER_COMPILED_LIBRARY
+#define FAST_DOUBLE_PARSER_COMPILED_LIBRARY 1
+#endif
+#include "fast_double_parser.h"
+
+namespace fast_double_parser {
+
+template struct powers_template<void>;
+
+template double compute_float_eisel_lemire<void>(int64_t, uint64_t, bool,
+                                                 bool *);
+
+template const char *parse_float_strtod<void>(const char *, double *);
+
+template const char *parse_float_strtod<char>(const char *, const char *,
+                                              double *);
+
+template bool compute_float_many_digits<char>(const char *, const char *,
+                                              int64_t, bool, double *);
+
+} // namespace fast_double_parser
@@ -0,0 +1,339 @@
+// Sharded correctness tests.
+//
+// Each test checks a range of inputs against a reference. The range may be
+// split into shards, each run as a separate test (see CMakeLists.txt), and
+// every shard is split across all the cores of the machine.
+//
+// usage: exhaustive <test> [<shard> <shards>]
+//
+// The shard may also be given by the TEST_SHARD_INDEX and TEST_TOTAL_SHARDS
+// environment variables, as set by Bazel.
+#include "fast_double_parser.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static inline uint64_t rng(uint64_t h) {
+  h ^= h >> 33;
+  h *= UINT64_C(0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  h *= UINT64_C(0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+  return h;
+}
+
+// The reference is the C library, in the C locale: strtod is correctly
+// rounded with glibc, macOS and recent versions of Visual Studio.
+double reference_strtod(const char *s) {
+#if defined(FAST_DOUBLE_PARSER_SOLARIS) || defined(FAST_DOUBLE_PARSER_CYGWIN)
+  char *endptr;
+  return cygwin_strtod_l(s, &endptr);
+#elif defined(_WIN32)
+  static _locale_t c_locale = _create_locale(LC_ALL, "C");
+  return _strtod_l(s, nullptr, c_locale);
+#else
+  static locale_t c_locale = newlocale(LC_ALL_MASK, "C", NULL);
+  return strtod_l(s, nullptr, c_locale);
+#endif
+}
+
+std::mutex report_mutex;
+std::atomic<uint64_t> failures{0};
+
+// Reports a failure; returns false so that checks can return its result.
+bool fail(const char *test, const std::string &input, const char *message) {
+  if (failures++ < 10) {
+    std::lock_guard<std::mutex> lock(report_mutex);
+    fprintf(stderr, "%s: %s: %s\n", test, input.c_str(), message);
+  }
+  return false;
+}
+
+bool same_double(double x, double y) {
+  return memcmp(&x, &y, sizeof(x)) == 0;
+}
+
+// Parses s, which must be a number in full, and compares with strtod.
+// Numbers too large for a double must be refused.
+bool check_double(const char *test, const std::string &s) {
+  double x;
+  const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+  if (std::isinf(reference_strtod(s.c_str()))) {
+    return (end == nullptr) ? true : fail(test, s, "infinity not refused");
+  }
+  if (end != s.c_str() + s.size()) {
+    return fail(test, s, "not parsed");
+  }
+  if (!same_double(x, reference_strtod(s.c_str()))) {
+    return fail(test, s, "differs from strtod");
+  }
+  return true;
+}
+
+// Random bit patterns, printed so that they round-trip and with fewer
+// digits.
+bool check_random(uint64_t i) {
+  uint64_t bits = rng(i);
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  if (!std::isfinite(d)) {
+    return true;
+  }
+  char buffer[64];
+  for (int digits : {17, 15, 6}) {
+    snprintf(buffer, sizeof(buffer), "%.*g", digits, d);
+    if (!check_double("random", buffer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Random bit patterns printed with 20 to 40 significant digits.
+bool check_long(uint64_t i) {
+  uint64_t bits = rng(i);
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  if (!std::isfinite(d)) {
+    return true;
+  }
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer), "%.*g", 20 + int(rng(i + 1) % 21), d);
+  return check_double("long", buffer);
+}
+
+// w * 10^q for every q in [-400, 400] and w of every size, including more
+// than 19 digits.
+const uint64_t power_count = 801;
+bool check_powers(uint64_t i) {
+  int q = int(i % power_count) - 400;
+  uint64_t w = rng(i) >> (rng(i + 1) % 64);
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%" PRIu64 "e%d", w, q);
+  if (!check_double("powers", buffer)) {
+    return false;
+  }
+  snprintf(buffer, sizeof(buffer), "%" PRIu64 "%" PRIu64 "e%d", w | 1,
+           rng(i + 2), q - 20);
+  return check_double("powers", buffer);
+}
+
+double half_to_double(fast_double_parser::binary16 x) {
+  int exponent = (x.bits >> 10) & 0x1F;
+  int mantissa = x.bits & 0x3FF;
+  double d = (exponent == 0x1F)  ? (mantissa ? NAN : INFINITY)
+             : (exponent == 0)   ? std::ldexp(mantissa, -24)
+                                 : std::ldexp(mantissa + 1024, exponent - 25);
+  return (x.bits >> 15) ? -d : d;
+}
+
+double half_to_double(fast_double_parser::bfloat16 x) {
+  uint32_t bits = uint32_t(x.bits) << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+template <typename T>
+bool check_half(const char *test, const std::string &s, uint16_t expected) {
+  T x{};
+  const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+  if (end != s.c_str() + s.size()) {
+    return fail(test, s, "not parsed");
+  }
+  if (x.bits != expected) {
+    return fail(test, s, "wrong value");
+  }
+  return true;
+}
+
+// Every 16-bit value, and the midpoint with the next one, written exactly
+// (it is exact as a double), plus and minus a little. The reference is the
+// bit pattern itself.
+template <typename T> bool check_16_bits(const char *test, uint64_t i) {
+  T x = {uint16_t(i)};
+  double d = half_to_double(x);
+  if (!std::isfinite(d)) {
+    return true;
+  }
+  char buffer[512];
+  snprintf(buffer, sizeof(buffer), "%.17g", d);
+  if (!check_half<T>(test, buffer, x.bits)) {
+    return false;
+  }
+  T next = {uint16_t(i + 1)};
+  double n = half_to_double(next);
+  if (((i & 0x7FFF) == 0x7FFF) || !std::isfinite(n)) {
+    return true;
+  }
+  double midpoint = (d + n) / 2;
+  snprintf(buffer, sizeof(buffer), "%.400g", midpoint);
+  std::string s(buffer);
+  size_t e = s.find('e');
+  std::string significand = s.substr(0, e);
+  std::string exponent = (e == std::string::npos) ? "" : s.substr(e);
+  if (significand.find('.') == std::string::npos) {
+    significand += ".";
+  }
+  // incrementing the bit pattern moves away from zero
+  uint16_t even = (i & 1) ? next.bits : x.bits;
+  if (!check_half<T>(test, s, even) ||
+      !check_half<T>(test, significand + "00000000000000000000" + exponent,
+                     even) ||
+      !check_half<T>(test, significand + "00000000000000000001" + exponent,
+                     next.bits)) {
+    return false;
+  }
+  snprintf(buffer, sizeof(buffer), "%.17g",
+           std::nextafter(midpoint, 2 * midpoint));
+  if (!check_half<T>(test, buffer, next.bits)) {
+    return false;
+  }
+  snprintf(buffer, sizeof(buffer), "%.17g", std::nextafter(midpoint, 0.0));
+  return check_half<T>(test, buffer, x.bits);
+}
+
+bool check_binary16(uint64_t i) {
+  return check_16_bits<fast_double_parser::binary16>("binary16", i);
+}
+
+bool check_bfloat16(uint64_t i) {
+  return check_16_bits<fast_double_parser::bfloat16>("bfloat16", i);
+}
+
+bool check_float(const char *test, const std::string &s, uint32_t expected) {
+  float x;
+  const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+  if (end != s.c_str() + s.size()) {
+    return fail(test, s, "not parsed");
+  }
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  if (bits != expected) {
+    return fail(test, s, "wrong float");
+  }
+  return true;
+}
+
+// A binary32 value, printed so that it round-trips, parsed as a double
+// and as a float, and the midpoint with the next value (exact as a double)
+// parsed as a float.
+bool check_binary32_bits(const char *test, uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  if (!std::isfinite(f)) {
+    return true;
+  }
+  char buffer[512];
+  snprintf(buffer, sizeof(buffer), "%.9g", f);
+  if (!check_double(test, buffer) || !check_float(test, buffer, bits)) {
+    return false;
+  }
+  uint32_t next_bits = bits + 1;
+  float next;
+  memcpy(&next, &next_bits, sizeof(next));
+  if (((bits & 0x7FFFFFFF) == 0x7FFFFFFF) || !std::isfinite(next)) {
+    return true;
+  }
+  snprintf(buffer, sizeof(buffer), "%.400g", (double(f) + double(next)) / 2);
+  // incrementing the bit pattern moves away from zero
+  return check_float(test, buffer, (bits & 1) ? next_bits : bits);
+}
+
+// Random binary32 values.
+bool check_binary32(uint64_t i) {
+  return check_binary32_bits("binary32", uint32_t(rng(i)));
+}
+
+// Every binary32 value.
+bool check_float32(uint64_t i) {
+  return check_binary32_bits("float32", uint32_t(i));
+}
+
+struct test_case {
+  const char *name;
+  bool (*check)(uint64_t);
+  uint64_t size;
+};
+
+const test_case tests[] = {
+    {"random", check_random, uint64_t(1) << 21},
+    {"powers", check_powers, power_count << 12},
+    {"long", check_long, uint64_t(1) << 20},
+    {"binary16", check_binary16, uint64_t(1) << 16},
+    {"bfloat16", check_bfloat16, uint64_t(1) << 16},
+    {"binary32", check_binary32, uint64_t(1) << 20},
+    {"float32", check_float32, uint64_t(1) << 32},
+};
+
+// Checks [begin, end), split across the cores.
+void run(const test_case &test, uint64_t begin, uint64_t end) {
+  uint64_t thread_count = std::thread::hardware_concurrency();
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  std::vector<std::thread> threads;
+  for (uint64_t t = 0; t < thread_count; t++) {
+    uint64_t first = begin + (end - begin) * t / thread_count;
+    uint64_t last = begin + (end - begin) * (t + 1) / thread_count;
+    threads.emplace_back([&test, first, last]() {
+      for (uint64_t i = first; (i < last) && (failures < 10); i++) {
+        test.check(i);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <test> [<shard> <shards>]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  uint64_t shard = 0;
+  uint64_t shards = 1;
+  if (argc >= 4) {
+    shard = strtoull(argv[2], nullptr, 10);
+    shards = strtoull(argv[3], nullptr, 10);
+  } else if (getenv("TEST_TOTAL_SHARDS") != nullptr) {
+    shard = strtoull(getenv("TEST_SHARD_INDEX"), nullptr, 10);
+    shards = strtoull(getenv("TEST_TOTAL_SHARDS"), nullptr, 10);
+    if (getenv("TEST_SHARD_STATUS_FILE") != nullptr) {
+      FILE *status = fopen(getenv("TEST_SHARD_STATUS_FILE"), "w");
+      if (status != nullptr) {
+        fclose(status);
+      }
+    }
+  }
+  if ((shards == 0) || (shard >= shards)) {
+    fprintf(stderr, "bad shard %" PRIu64 " of %" PRIu64 "\n", shard, shards);
+    return EXIT_FAILURE;
+  }
+  for (const test_case &test : tests) {
+    if (strcmp(test.name, argv[1]) != 0) {
+      continue;
+    }
+    uint64_t begin = test.size * shard / shards;
+    uint64_t end = test.size * (shard + 1) / shards;
+    run(test, begin, end);
+    if (failures != 0) {
+      printf("%s: shard %" PRIu64 " of %" PRIu64 " failed\n", test.name,
+             shard, shards);
+      return EXIT_FAILURE;
+    }
+    printf("%s: shard %" PRIu64 " of %" PRIu64 " ok (%" PRIu64 " inputs)\n",
+           test.name, shard, shards, end - begin);
+    return EXIT_SUCCESS;
+  }
+  fprintf(stderr, "unknown test %s\n", argv[1]);
+  return EXIT_FAILURE;
+}
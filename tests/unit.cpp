@@ -1,10 +1,17 @@
 #include "fast_double_parser.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
+#ifndef _WIN32
+#include "number_cache.h"
+#include "number_ingest.h"
+#endif
 
 // ulp distance
 // Marc B. Reynolds, 2016-2019
@@ -101,6 +108,18 @@ void unit_tests() {
   for (std::string s : {"7.3177701707893310e+15","1e23", "9007199254740995","7e23"}) {
     check_string(s);
   }
+  // More than 19 significant digits: the first 19 digits and the next value
+  // up usually round to the same double, otherwise we need strtod.
+  for (std::string s : {"3.1415926535897932384626433832795028841971693993751",
+                        "9007199254740993.0000000000000000001",
+                        "9007199254740993.0000000000000000000",
+                        "9007199254740992.9999999999999999999",
+                        "100000000000000000000000000000000000000000000e-20",
+                        "0.000000000000000000000123456789012345678901234567",
+                        "-12345678901234567890123456789e-300",
+                        "17976931348623157081452742373170435679807056752584e258"}) {
+    check_string(s);
+  }
   for (double d : {-65.613616999999977, 7.2057594037927933e+16, 1.0e-308,
                    0.1e-308, 0.01e-307, 1.79769e+308, 2.22507e-308,
                    -1.79769e+308, -2.22507e-308, 1e-308}) {
@@ -236,6 +255,116 @@ void negative_subsubnormal_to_negative_zero() {
   std::cout << "-1e-999 parses to -0" << std::endl;
 }
 
+// Subnormal results are computed by the fast algorithm, with the same
+// rounding as strtod, down to zero.
+void subnormals() {
+  for (std::string s : {"4.9406564584124654e-324", "-4.9406564584124654e-324",
+                        "2.4703282292062327e-324", "2.4703282292062328e-324",
+                        "7.4109846876186982e-324", "2.2250738585072009e-308",
+                        "2.2250738585072011e-308", "2.2250738585072014e-308",
+                        "1e-320", "123456789e-330", "1e-323", "9e-324"}) {
+    check_string(s);
+  }
+  for (uint64_t i = 1; i <= 100000; i++) {
+    uint64_t x = rng(i) & ((uint64_t(1) << 52) - 1);
+    double d;
+    ::memcpy(&d, &x, sizeof(double));
+    check(d);
+    check(-d);
+  }
+  std::cout << "subnormals ok" << std::endl;
+}
+
+// Exponents beyond the table of powers give signed zeros or are refused,
+// like strtod, for significands of any length.
+void out_of_range_exponents() {
+  for (std::string significand :
+       {"0", "0.000", "1", "9.999", "123", "9999999999999999999",
+        "0.0000000000000000000000001", "12345678901234567890123",
+        "1.00000000000000000000000000001", "0.00000000000000000000000000000"}) {
+    for (const char *exponent :
+         {"-99999999999", "-400", "-343", "-342", "-325", "-324", "-305",
+          "288", "289", "308", "309", "400", "999", "99999999999"}) {
+      for (const char *sign : {"", "-"}) {
+        std::string s = sign + significand + "e" + exponent;
+#if defined(FAST_DOUBLE_PARSER_SOLARIS) || defined(FAST_DOUBLE_PARSER_CYGWIN)
+        char *endptr;
+        double expected = cygwin_strtod_l(s.c_str(), &endptr);
+#elif defined(_WIN32)
+        static _locale_t c_locale = _create_locale(LC_ALL, "C");
+        double expected = _strtod_l(s.c_str(), nullptr, c_locale);
+#else
+        static locale_t c_locale = newlocale(LC_ALL_MASK, "C", NULL);
+        double expected = strtod_l(s.c_str(), nullptr, c_locale);
+#endif
+        double x;
+        const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+        bool ok = std::isinf(expected)
+                      ? (end == nullptr)
+                      : ((end == s.c_str() + s.size()) && (x == expected) &&
+                         (std::signbit(x) == std::signbit(expected)));
+        if (!ok) {
+          printf("out-of-range exponent in %s\n", s.c_str());
+          throw std::runtime_error("bad out-of-range exponent");
+        }
+      }
+    }
+  }
+  std::cout << "out-of-range exponents ok" << std::endl;
+}
+
+// Numbers right between two doubles are rounded to even without leaving
+// compute_float_64.
+void check_midpoint(int64_t power, uint64_t w) {
+  std::string s = std::to_string(w) + "e" + std::to_string(power);
+  bool success = false;
+  fast_double_parser::compute_float_64(power, w, false, &success);
+  if (!success) {
+    printf("compute_float_64 failed on %s\n", s.c_str());
+    throw std::runtime_error("compute_float_64 failed on a midpoint");
+  }
+  // compares with strtod
+  check_string(s);
+}
+
+void exact_midpoints() {
+  check_midpoint(23, 1);
+  check_midpoint(0, 9007199254740993);
+  check_midpoint(0, 9007199254740995);
+  check_midpoint(-1, 45035996273704975);
+  check_midpoint(-4, 5629499534213120625);
+  check_midpoint(-15, 7317770170789331);
+  for (uint64_t i = 1; i <= 100000; i++) {
+    // (2^53 + odd) * 2^k is a midpoint, printed as an integer w * 10^q with
+    // q >= 0 when it has trailing zeros
+    int k = int(rng(i) % 11);
+    uint64_t w = ((uint64_t(1) << 53) + (rng(i + 1) % (uint64_t(1) << 53) | 1))
+                 << k;
+    int64_t power = 0;
+    while ((w % 10) == 0) {
+      w /= 10;
+      power++;
+    }
+    check_midpoint(power, w);
+    // the midpoint m / 2^j, for small j, is w * 10^-j with w = m * 5^j
+    uint64_t m = (uint64_t(1) << 53) + (rng(i + 2) % (uint64_t(1) << 53) | 1);
+    int j = int(rng(i + 3) % 5);
+    uint64_t p5 = 1;
+    for (int t = 0; t < j; t++) {
+      p5 *= 5;
+    }
+    if (m <= UINT64_MAX / p5) {
+      check_midpoint(-j, m * p5);
+    }
+  }
+  for (int64_t power = 0; power <= 23; power++) {
+    check_midpoint(power, 1);
+    check_midpoint(power, 3);
+    check_midpoint(power, 9007199254740993);
+  }
+  std::cout << "exact midpoints ok" << std::endl;
+}
+
 void issue50_fastpath() {
   std::string a = "-0.0";
   double x;
@@ -294,6 +423,1295 @@ void issue2093() {
 }
 
 
+void bulk_parse_all_instruction_sets() {
+  // assorted separators, including runs long enough for the vector kernels
+  std::string input;
+  std::vector<double> expected;
+  const char *separators[] = {" ", ",", "\n", "\r\n", "\t", ", ",
+                              "                                        ",
+                              "\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n"
+                              "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+                              ",,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,"};
+  for (size_t i = 1; i <= 5000; i++) {
+    double d;
+    uint64_t x = rng(i);
+    ::memcpy(&d, &x, sizeof(double));
+    if (!std::isfinite(d)) {
+      continue;
+    }
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", d);
+    input += separators[i % (sizeof(separators) / sizeof(separators[0]))];
+    input += buffer;
+    expected.push_back(d);
+  }
+  for (fast_double_parser::instruction_set set :
+       {fast_double_parser::instruction_set::scalar,
+        fast_double_parser::instruction_set::sse42,
+        fast_double_parser::instruction_set::avx2,
+        fast_double_parser::instruction_set::avx512}) {
+    if (!fast_double_parser::force_instruction_set(set)) {
+      std::cout << "skipping unsupported "
+                << fast_double_parser::instruction_set_name(set) << std::endl;
+      continue;
+    }
+    std::vector<double> values(expected.size());
+    size_t count;
+    const char *end = input.data() + input.size();
+    // copy to a buffer that is not null terminated
+    std::vector<char> unterminated(input.begin(), input.end());
+    const char *stop = fast_double_parser::parse_numbers(
+        unterminated.data(), unterminated.data() + unterminated.size(),
+        values.data(), values.size(), &count);
+    if (stop != unterminated.data() + unterminated.size()) {
+      throw std::runtime_error("bulk parsing stopped early");
+    }
+    if ((count != expected.size()) || (values != expected)) {
+      throw std::runtime_error("bulk parsing disagrees");
+    }
+    // too little room: we stop at the start of the first number left out
+    stop = fast_double_parser::parse_numbers(input.data(), end, values.data(),
+                                             10, &count);
+    if ((count != 10) || (stop == end) || !fast_double_parser::is_integer(
+                                              stop[stop[0] == '-' ? 1 : 0])) {
+      throw std::runtime_error("bulk parsing overran its output");
+    }
+    // an invalid number stops the parsing
+    std::string bad = "1.5 , 2e3\t\t0.25x 4";
+    stop = fast_double_parser::parse_numbers(
+        bad.data(), bad.data() + bad.size(), values.data(), values.size(),
+        &count);
+    if ((count != 2) || (stop != bad.data() + 11)) {
+      throw std::runtime_error("bulk parsing did not stop on a bad number");
+    }
+    // the parsing stops at a number too large for a double, and numbers
+    // that need strtod are converted in order with the others
+    std::string batch;
+    for (int k = 0; k < 40; k++) {
+      // every fifth number is the midpoint between 1 and the next double
+      batch += (k == 37)      ? "1e400 "
+               : (k % 5 == 0) ? "1.00000000000000011102230246251565404236"
+                                "316680908203125 "
+                              : "0.5 ";
+    }
+    stop = fast_double_parser::parse_numbers(
+        batch.data(), batch.data() + batch.size(), values.data(),
+        values.size(), &count);
+    if ((count != 37) || (strncmp(stop, "1e400", 5) != 0) ||
+        (values[35] != 1) || (values[36] != 0.5)) {
+      throw std::runtime_error("bulk parsing did not stop on overflow");
+    }
+    std::cout << "bulk parsing ok with "
+              << fast_double_parser::instruction_set_name(
+                     fast_double_parser::active_instruction_set())
+              << std::endl;
+  }
+  fast_double_parser::force_instruction_set(
+      fast_double_parser::instruction_set::automatic);
+}
+
+
+void trusted_parsing() {
+  for (std::string s : {"0", "-0", "-0.0", "1e23", "9007199254740995", "0.1",
+                        "-65.613616999999977", "1.7976931348623157e308",
+                        "2.2250738585072014E-308", "4.9406564584124654e-324",
+                        "0.000000000000000000000000000000001234", "5e+0012"}) {
+    double expected, x;
+    const char *end = fast_double_parser::parse_number(s.c_str(), &expected);
+    const char *trusted_end =
+        fast_double_parser::parse_number_trusted(s.c_str(), &x);
+    if ((end != trusted_end) || (end != s.c_str() + s.size()) ||
+        (x != expected) || (std::signbit(x) != std::signbit(expected))) {
+      std::cerr << "trusted parsing disagrees on " << s << std::endl;
+      throw std::runtime_error("trusted parsing disagrees");
+    }
+  }
+  for (size_t i = 1; i <= 100000; i++) {
+    uint64_t x = rng(i);
+    double d, result;
+    ::memcpy(&d, &x, sizeof(double));
+    if (!std::isfinite(d)) {
+      continue;
+    }
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", d);
+    const char *end = fast_double_parser::parse_number_trusted(buffer, &result);
+    if ((end != buffer + strlen(buffer)) || (result != d)) {
+      std::cerr << "trusted parsing disagrees on " << buffer << std::endl;
+      throw std::runtime_error("trusted parsing disagrees");
+    }
+  }
+  std::cout << "trusted parsing ok" << std::endl;
+}
+
+template <typename UC> void check_code_units(const std::string &s) {
+  std::basic_string<UC> wide(s.begin(), s.end());
+  double expected, x;
+  const char *end = fast_double_parser::parse_number(s.c_str(), &expected);
+  const UC *wide_end = fast_double_parser::parse_number(wide.c_str(), &x);
+  if ((end == nullptr) != (wide_end == nullptr)) {
+    std::cerr << "code units disagree on " << s << std::endl;
+    throw std::runtime_error("code units disagree on validity");
+  }
+  if (end == nullptr) {
+    return;
+  }
+  if ((wide_end - wide.c_str() != end - s.c_str()) || (x != expected) ||
+      (std::signbit(x) != std::signbit(expected))) {
+    std::cerr << "code units disagree on " << s << std::endl;
+    throw std::runtime_error("code units disagree");
+  }
+}
+
+void wide_code_units() {
+  std::vector<std::string> inputs = {
+      "0", "-0.0", "1e23", "-65.613616999999977", "0.", "-", "01", "1e",
+      "3.1415926535897932384626433832795028841971693993751", "1e-400",
+      "1e400", "123,456", "4.9406564584124654e-324"};
+  for (size_t i = 1; i <= 10000; i++) {
+    uint64_t x = rng(i);
+    double d;
+    ::memcpy(&d, &x, sizeof(double));
+    if (std::isfinite(d)) {
+      char buffer[64];
+      snprintf(buffer, sizeof(buffer), "%.17g", d);
+      inputs.push_back(buffer);
+    }
+  }
+  for (const std::string &s : inputs) {
+    check_code_units<char16_t>(s);
+    check_code_units<char32_t>(s);
+    check_code_units<wchar_t>(s);
+    check_code_units<unsigned char>(s);
+#ifdef __cpp_char8_t
+    check_code_units<char8_t>(s);
+#endif
+  }
+  // a code unit that only matches a digit once truncated to 8 bits
+  std::u16string s = u"12\u0133";
+  double x;
+  const char16_t *end = fast_double_parser::parse_number(s.c_str(), &x);
+  if ((end != s.c_str() + 2) || (x != 12)) {
+    throw std::runtime_error("wide code unit taken for a digit");
+  }
+  std::cout << "wide code units ok" << std::endl;
+}
+
+// The value of a binary16 or bfloat16 bit pattern, as a double.
+double half_to_double(fast_double_parser::binary16 x) {
+  int exponent = (x.bits >> 10) & 0x1F;
+  int mantissa = x.bits & 0x3FF;
+  double d = (exponent == 0x1F)  ? (mantissa ? NAN : INFINITY)
+             : (exponent == 0)   ? std::ldexp(mantissa, -24)
+                                 : std::ldexp(mantissa + 1024, exponent - 25);
+  return (x.bits >> 15) ? -d : d;
+}
+
+double half_to_double(fast_double_parser::bfloat16 x) {
+  uint32_t bits = uint32_t(x.bits) << 16;
+  float f;
+  ::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+// Parses s as T and checks that we get the expected bit pattern, also when
+// the significand has trailing zeros appended (which takes the slow path).
+template <typename T>
+void check_half(const std::string &s, uint16_t expected) {
+  size_t e = s.find_first_of("eE");
+  std::string padded = s.substr(0, e);
+  if (padded.find('.') == std::string::npos) {
+    padded += ".";
+  }
+  padded += "00000000000000000000";
+  if (e != std::string::npos) {
+    padded += s.substr(e);
+  }
+  for (const std::string &input : {s, padded}) {
+    T x{};
+    const char *end = fast_double_parser::parse_number(input.c_str(), &x);
+    if ((end != input.c_str() + input.size()) || (x.bits != expected)) {
+      fprintf(stderr, "parsing %s: expected 0x%04x, got 0x%04x\n",
+              input.c_str(), expected, x.bits);
+      throw std::runtime_error("bad 16-bit value");
+    }
+  }
+}
+
+// Checks every finite value, and the neighbourhood of midpoints between
+// consecutive values, where parsing to a double first would round twice.
+template <typename T> void half_precision_exhaustive() {
+  char buffer[512];
+  for (uint32_t bits = 0; bits < 0x10000; bits++) {
+    T x = {uint16_t(bits)};
+    double d = half_to_double(x);
+    if (!std::isfinite(d)) {
+      continue;
+    }
+    snprintf(buffer, sizeof(buffer), "%.17g", d);
+    check_half<T>(buffer, x.bits);
+    T next = {uint16_t(bits + 1)};
+    double n = half_to_double(next);
+    if (((bits & 0x7FFF) == 0x7FFF) || !std::isfinite(n)) {
+      continue;
+    }
+    // all subnormal midpoints, and a sample of the others (the exhaustive
+    // tests check them all)
+    if (((bits & 0x7FFF) >= 0x400) && (bits % 16 != 0)) {
+      continue;
+    }
+    // the midpoint is exact as a double and written out in full
+    double midpoint = (d + n) / 2;
+    uint16_t even = (bits & 1) ? next.bits : x.bits;
+    // incrementing the bit pattern moves away from zero
+    uint16_t away = next.bits;
+    uint16_t toward = x.bits;
+    snprintf(buffer, sizeof(buffer), "%.400g", midpoint);
+    check_half<T>(buffer, even);
+    std::string s(buffer);
+    size_t e = s.find('e');
+    std::string significand = s.substr(0, e);
+    std::string exponent = (e == std::string::npos) ? "" : s.substr(e);
+    if (significand.find('.') == std::string::npos) {
+      significand += ".";
+    }
+    check_half<T>(significand + "0000000000000000000000001" + exponent,
+                  away);
+    snprintf(buffer, sizeof(buffer), "%.17g",
+             std::nextafter(midpoint, 2 * midpoint));
+    check_half<T>(buffer, away);
+    snprintf(buffer, sizeof(buffer), "%.17g", std::nextafter(midpoint, 0.0));
+    check_half<T>(buffer, toward);
+  }
+}
+
+void half_precision() {
+  half_precision_exhaustive<fast_double_parser::binary16>();
+  half_precision_exhaustive<fast_double_parser::bfloat16>();
+  // rounding to a double first would give 1.00048828125 and then 1
+  check_half<fast_double_parser::binary16>("1.000488281250000001", 0x3C01);
+  check_half<fast_double_parser::binary16>("1.00048828125", 0x3C00);
+  // midpoint between the two smallest subnormals, in the fast path
+  check_half<fast_double_parser::binary16>("2.98023223876953125e-8", 0x0000);
+  check_half<fast_double_parser::binary16>("8.94069671630859375e-8", 0x0002);
+  check_half<fast_double_parser::binary16>("-0", 0x8000);
+  check_half<fast_double_parser::binary16>("1e-400", 0x0000);
+  check_half<fast_double_parser::binary16>("65519.99", 0x7BFF);
+  check_half<fast_double_parser::bfloat16>("3.3895313892515355e38", 0x7F7F);
+  check_half<fast_double_parser::bfloat16>("-1e-60", 0x8000);
+  // values that do not fit are refused, like for binary64
+  for (const char *s : {"65520", "1e5", "-1e400", "nan"}) {
+    fast_double_parser::binary16 x;
+    if (fast_double_parser::parse_number(s, &x) != nullptr) {
+      throw std::runtime_error("accepted a value too large for binary16");
+    }
+  }
+  fast_double_parser::bfloat16 y;
+  if (fast_double_parser::parse_number("3.4e38", &y) != nullptr) {
+    throw std::runtime_error("accepted a value too large for bfloat16");
+  }
+  // wide code units and bulk parsing
+  fast_double_parser::binary16 z;
+  if ((fast_double_parser::parse_number(u"0.5", &z) == nullptr) ||
+      (z.bits != 0x3800)) {
+    throw std::runtime_error("bad binary16 from char16_t");
+  }
+  std::vector<std::string> tokens = {"1", "0.1", "-2.5e-3", "65504",
+                                     "1.000488281250000001"};
+  std::string input = "1, 0.1\n-2.5e-3 65504 1.000488281250000001";
+  std::vector<fast_double_parser::binary16> halves(tokens.size());
+  std::vector<fast_double_parser::bfloat16> brains(tokens.size());
+  for (uint32_t set : {1, 2, 4, 8}) {
+    if (!fast_double_parser::force_instruction_set(
+            fast_double_parser::instruction_set(set))) {
+      continue;
+    }
+    size_t half_count, brain_count;
+    const char *half_end = fast_double_parser::parse_numbers(
+        input.data(), input.data() + input.size(), halves.data(),
+        halves.size(), &half_count);
+    const char *brain_end = fast_double_parser::parse_numbers(
+        input.data(), input.data() + input.size(), brains.data(),
+        brains.size(), &brain_count);
+    if ((half_end != input.data() + input.size()) ||
+        (brain_end != input.data() + input.size()) ||
+        (half_count != tokens.size()) || (brain_count != tokens.size())) {
+      throw std::runtime_error("bulk 16-bit parsing failed");
+    }
+    for (size_t i = 0; i < tokens.size(); i++) {
+      fast_double_parser::binary16 h;
+      fast_double_parser::bfloat16 b;
+      if ((fast_double_parser::parse_number(tokens[i].c_str(), &h) ==
+           nullptr) ||
+          (fast_double_parser::parse_number(tokens[i].c_str(), &b) ==
+           nullptr) ||
+          (halves[i].bits != h.bits) || (brains[i].bits != b.bits)) {
+        throw std::runtime_error("bulk 16-bit values differ");
+      }
+    }
+  }
+  fast_double_parser::force_instruction_set(
+      fast_double_parser::instruction_set::automatic);
+  std::cout << "half precision ok" << std::endl;
+}
+
+void check_float(const std::string &s, float expected) {
+  float x;
+  const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+  if ((end != s.c_str() + s.size()) ||
+      (memcmp(&x, &expected, sizeof(x)) != 0)) {
+    fprintf(stderr, "bad float for %s: %.9g, expected %.9g\n", s.c_str(), x,
+            expected);
+    throw std::runtime_error("bad float");
+  }
+}
+
+void single_precision() {
+  // rounding to a double first would give the midpoint, and then 1
+  check_float("1.0000000596046447753906250001", 1.00000012f);
+  check_float("1.000000059604644775390625", 1.0f);
+  check_float("1.000000178813934326171875", 1.00000024f);
+  check_float("3.4028234663852886e38", 3.4028234663852886e38f);
+  check_float("1.17549435e-38", 1.17549435e-38f);
+  check_float("1.4e-45", 1.4e-45f);
+  check_float("7e-46", 0.0f);
+  check_float("-1e-400", -0.0f);
+  check_float("16777217", 16777216.0f);
+  check_float("16777219", 16777220.0f);
+  check_float("0.1", 0.1f);
+  check_float("3.14159265358979323846264338327950288", 3.14159265f);
+  for (const char *s : {"3.4028236e38", "1e39", "-1e400"}) {
+    float x;
+    if (fast_double_parser::parse_number(s, &x) != nullptr) {
+      throw std::runtime_error("accepted a value too large for a float");
+    }
+  }
+  // random floats, which round-trip, and the midpoints after them, which
+  // are exact as doubles
+  for (uint64_t i = 1; i <= 100000; i++) {
+    uint32_t bits = uint32_t(rng(i));
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    if (!std::isfinite(f)) {
+      continue;
+    }
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "%.9g", f);
+    check_float(buffer, f);
+    float next = std::nextafter(f, f < 0 ? -INFINITY : INFINITY);
+    if (!std::isfinite(next)) {
+      continue;
+    }
+    snprintf(buffer, sizeof(buffer), "%.400g", (double(f) + double(next)) / 2);
+    check_float(buffer, (bits & 1) ? next : f);
+  }
+  std::string input = "1.5, 0.1\n-2.5e-3 3.4028234663852886e38";
+  std::vector<float> values(4);
+  size_t count;
+  if ((fast_double_parser::parse_numbers(input.data(),
+                                         input.data() + input.size(),
+                                         values.data(), values.size(),
+                                         &count) !=
+       input.data() + input.size()) ||
+      (count != 4) || (values[1] != 0.1f) || (values[2] != -2.5e-3f) ||
+      (values[3] != 3.4028234663852886e38f)) {
+    throw std::runtime_error("bulk float parsing failed");
+  }
+  std::cout << "single precision ok" << std::endl;
+}
+
+template <typename offset_type> void check_column(bool with_nulls) {
+  // adjacent rows of digits, rows that do not parse, empty rows, long rows
+  std::vector<std::string> rows;
+  for (size_t i = 0; i < 1001; i++) {
+    switch (rng(i) % 8) {
+    case 0:
+      rows.push_back("");
+      break;
+    case 1:
+      rows.push_back("1e");
+      break;
+    case 2:
+      rows.push_back("3.1415926535897932384626433832795028841971693993751");
+      break;
+    case 3:
+      rows.push_back("1 ");
+      break;
+    default:
+      rows.push_back(std::to_string(rng(i) % 100000));
+    }
+  }
+  std::string data;
+  std::vector<offset_type> offsets = {0};
+  std::vector<uint8_t> input_validity((rows.size() + 7) / 8);
+  for (size_t i = 0; i < rows.size(); i++) {
+    data += rows[i];
+    offsets.push_back(offset_type(data.size()));
+    // whole blocks of nulls, and scattered ones
+    bool valid = !with_nulls || ((i / 64 != 3) && (rng(i + 7) % 4 != 0));
+    input_validity[i / 8] |= uint8_t(valid) << (i % 8);
+  }
+  std::vector<double> out(rows.size(), -1);
+  std::vector<uint8_t> output_validity((rows.size() + 7) / 8, 0xFF);
+  size_t failures = fast_double_parser::parse_column(
+      offsets.data(), data.data(), rows.size(),
+      with_nulls ? input_validity.data() : nullptr, out.data(),
+      output_validity.data());
+  size_t expected_failures = 0;
+  for (size_t i = 0; i < rows.size(); i++) {
+    bool valid = (input_validity[i / 8] >> (i % 8)) & 1;
+    double expected = 0;
+    const char *end =
+        fast_double_parser::parse_number(rows[i].c_str(), &expected);
+    bool parsed = valid && (end == rows[i].c_str() + rows[i].size());
+    if (valid && !parsed) {
+      expected_failures++;
+    }
+    if (!parsed) {
+      expected = 0;
+    }
+    if ((((output_validity[i / 8] >> (i % 8)) & 1) != parsed) ||
+        (out[i] != expected)) {
+      printf("row %zu (%s) was not parsed correctly\n", i, rows[i].c_str());
+      throw std::runtime_error("bad column parsing");
+    }
+  }
+  // the bits past the last row are cleared
+  if ((failures != expected_failures) ||
+      ((output_validity.back() >> (rows.size() % 8)) != 0)) {
+    throw std::runtime_error("bad column parsing");
+  }
+}
+
+void column_parsing() {
+  check_column<int32_t>(false);
+  check_column<int32_t>(true);
+  check_column<int64_t>(false);
+  check_column<int64_t>(true);
+  std::cout << "column parsing ok" << std::endl;
+}
+
+void lazy_parsing() {
+  std::vector<std::string> inputs = {
+      "0", "-0.0", "1e23", "-65.613616999999977", "1e-400", "1e400",
+      "-1e99999999999999999",
+      "3.1415926535897932384626433832795028841971693993751",
+      "4.9406564584124654e-324", "1.7976931348623157e308"};
+  for (size_t i = 1; i <= 10000; i++) {
+    uint64_t x = rng(i);
+    double d;
+    ::memcpy(&d, &x, sizeof(double));
+    if (std::isfinite(d)) {
+      char buffer[64];
+      snprintf(buffer, sizeof(buffer), "%.17g", d);
+      inputs.push_back(buffer);
+    }
+  }
+  std::string all;
+  for (const std::string &s : inputs) {
+    fast_double_parser::lazy_double lazy;
+    const char *end = fast_double_parser::parse_number(s.c_str(), &lazy);
+    if ((end != s.c_str() + s.size()) || (lazy.begin() != s.c_str()) ||
+        (lazy.end() != end) || lazy.converted()) {
+      throw std::runtime_error("bad lazy number span");
+    }
+    double expected;
+    if (fast_double_parser::parse_number(s.c_str(), &expected) == nullptr) {
+      // too large: refused by parse_number, infinite when lazy
+      expected = (s[0] == '-') ? -INFINITY : INFINITY;
+    }
+    if ((lazy.value() != expected) || !lazy.converted() ||
+        (lazy.value() != expected) ||
+        (std::signbit(lazy.value()) != std::signbit(expected))) {
+      printf("lazy parsing of %s failed\n", s.c_str());
+      throw std::runtime_error("bad lazy number value");
+    }
+    all += s;
+    all += ' ';
+  }
+  // bad input is refused up front
+  for (const char *s : {"", "-", "1e", ".5", "01", "1.e5"}) {
+    fast_double_parser::lazy_double lazy;
+    if (fast_double_parser::parse_number(s, &lazy) != nullptr) {
+      throw std::runtime_error("lazy parsing accepted bad input");
+    }
+  }
+  // in bulk, the last number is parsed from a copy: its span must still
+  // point into the input
+  all.pop_back();
+  std::vector<fast_double_parser::lazy_double> tape(inputs.size());
+  size_t count;
+  const char *end = fast_double_parser::parse_numbers(
+      all.data(), all.data() + all.size(), tape.data(), tape.size(), &count);
+  if ((end != all.data() + all.size()) || (count != inputs.size()) ||
+      (tape.back().begin() != all.data() + all.size() -
+                                  inputs.back().size()) ||
+      (tape.back().end() != end)) {
+    throw std::runtime_error("bad lazy bulk parsing");
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (std::string(tape[i].begin(), tape[i].length()) != inputs[i]) {
+      throw std::runtime_error("bad lazy bulk span");
+    }
+  }
+  std::cout << "lazy parsing ok" << std::endl;
+}
+
+void check_tagged(const std::string &s, fast_double_parser::number_type type,
+                  uint64_t bits) {
+  fast_double_parser::tagged_number x{};
+  const char *end = fast_double_parser::parse_number(s.c_str(), &x);
+  uint64_t x_bits;
+  ::memcpy(&x_bits, &x.uint64_value, sizeof(x_bits)); // any member
+  if ((end != s.c_str() + s.size()) || (x.type != type) || (x_bits != bits)) {
+    printf("parsing %s: got type %d and bits 0x%016" PRIx64 "\n", s.c_str(),
+           int(x.type), x_bits);
+    throw std::runtime_error("bad tagged number");
+  }
+}
+
+uint64_t double_bits(double d) {
+  uint64_t bits;
+  ::memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+void tagged_numbers() {
+  using fast_double_parser::number_type;
+  check_tagged("0", number_type::signed_integer, 0);
+  check_tagged("-0", number_type::floating_point, double_bits(-0.0));
+  check_tagged("-1", number_type::signed_integer, uint64_t(-1));
+  check_tagged("9007199254740993", number_type::signed_integer,
+               9007199254740993);
+  check_tagged("9223372036854775807", number_type::signed_integer,
+               9223372036854775807);
+  check_tagged("-9223372036854775808", number_type::signed_integer,
+               uint64_t(1) << 63);
+  check_tagged("-9223372036854775809", number_type::floating_point,
+               double_bits(-9223372036854775809.0));
+  check_tagged("9223372036854775808", number_type::unsigned_integer,
+               uint64_t(1) << 63);
+  check_tagged("9999999999999999999", number_type::unsigned_integer,
+               9999999999999999999u);
+  check_tagged("10000000000000000000", number_type::unsigned_integer,
+               10000000000000000000u);
+  check_tagged("18446744073709551615", number_type::unsigned_integer,
+               18446744073709551615u);
+  // 2^64 wraps around to zero, 2 * 10^19 does not start with 1
+  check_tagged("18446744073709551616", number_type::floating_point,
+               double_bits(18446744073709551616.0));
+  check_tagged("19999999999999999999", number_type::floating_point,
+               double_bits(19999999999999999999.0));
+  check_tagged("20000000000000000000", number_type::floating_point,
+               double_bits(20000000000000000000.0));
+  check_tagged("100000000000000000000", number_type::floating_point,
+               double_bits(1e20));
+  check_tagged("1.0", number_type::floating_point, double_bits(1.0));
+  check_tagged("1e2", number_type::floating_point, double_bits(100.0));
+  check_tagged("-2.5E-3", number_type::floating_point, double_bits(-2.5e-3));
+  for (const char *s : {"", "-", "01", "1.", "1e", "+1"}) {
+    fast_double_parser::tagged_number x;
+    if (fast_double_parser::parse_number(s, &x) != nullptr) {
+      throw std::runtime_error("accepted a bad number");
+    }
+  }
+  for (size_t i = 1; i <= 10000; i++) {
+    uint64_t x = rng(i) >> (i % 64);
+    check_tagged(std::to_string(x),
+                 (x <= uint64_t(INT64_MAX)) ? number_type::signed_integer
+                                            : number_type::unsigned_integer,
+                 x);
+    int64_t y = int64_t(rng(i + 1)) >> (i % 64);
+    if (y < 0) {
+      check_tagged(std::to_string(y), number_type::signed_integer,
+                   uint64_t(y));
+    }
+  }
+  // in bulk, and from wide characters
+  std::string input = "1 -2 3.5 18446744073709551615";
+  std::vector<fast_double_parser::tagged_number> values(4);
+  size_t count;
+  if ((fast_double_parser::parse_numbers(input.data(),
+                                         input.data() + input.size(),
+                                         values.data(), values.size(),
+                                         &count) !=
+       input.data() + input.size()) ||
+      (count != 4) || (values[0].int64_value != 1) ||
+      (values[1].int64_value != -2) || (values[2].double_value != 3.5) ||
+      (values[3].type != number_type::unsigned_integer)) {
+    throw std::runtime_error("bad bulk tagged numbers");
+  }
+  fast_double_parser::tagged_number w;
+  if ((fast_double_parser::parse_number(u"-42", &w) == nullptr) ||
+      (w.type != number_type::signed_integer) || (w.int64_value != -42)) {
+    throw std::runtime_error("bad tagged number from char16_t");
+  }
+  std::cout << "tagged numbers ok" << std::endl;
+}
+
+// The bounds of the numbers in s, one byte at a time.
+void naive_index(const std::string &s, std::vector<size_t> *starts,
+                 std::vector<size_t> *ends) {
+  for (size_t i = 0; i < s.size(); i++) {
+    bool separator = fast_double_parser::is_separator(s[i]);
+    bool after_separator =
+        (i == 0) || fast_double_parser::is_separator(s[i - 1]);
+    if (!separator && after_separator) {
+      starts->push_back(i);
+    }
+    if (separator && !after_separator) {
+      ends->push_back(i);
+    }
+  }
+  if (ends->size() < starts->size()) {
+    ends->push_back(s.size());
+  }
+}
+
+void check_index(const std::string &input) {
+  std::vector<size_t> expected_starts, expected_ends;
+  naive_index(input, &expected_starts, &expected_ends);
+  // the buffer is not null terminated
+  std::vector<char> buffer(input.begin(), input.end());
+  const char *begin = buffer.data();
+  const char *end = begin + buffer.size();
+  size_t n = expected_starts.size();
+  std::vector<const char *> starts(n + 1), ends(n + 1);
+  size_t count;
+  if ((fast_double_parser::index_numbers(begin, end, starts.data(),
+                                         ends.data(), n + 1, &count) != end) ||
+      (count != n)) {
+    printf("indexing of '%s' found %zu numbers\n", input.c_str(), count);
+    throw std::runtime_error("bad index");
+  }
+  for (size_t i = 0; i < n; i++) {
+    if ((size_t(starts[i] - begin) != expected_starts[i]) ||
+        (size_t(ends[i] - begin) != expected_ends[i])) {
+      printf("indexing of '%s' gave [%zu, %zu) for number %zu\n",
+             input.c_str(), size_t(starts[i] - begin),
+             size_t(ends[i] - begin), i);
+      throw std::runtime_error("bad index");
+    }
+  }
+  // too little room: we stop at the start of the first number left out
+  for (size_t capacity : {size_t(0), size_t(1), n / 2, n - (n > 0)}) {
+    if (capacity >= n) {
+      continue;
+    }
+    const char *stop = fast_double_parser::index_numbers(
+        begin, end, starts.data(), ends.data(), capacity, &count);
+    if ((count != capacity) || (stop != begin + expected_starts[capacity]) ||
+        ((capacity > 0) &&
+         (ends[capacity - 1] != begin + expected_ends[capacity - 1]))) {
+      throw std::runtime_error("indexing overran its output");
+    }
+  }
+}
+
+void number_index() {
+  // tokens and runs of separators that cross the 64-byte blocks, including
+  // bytes that are neither digits nor separators
+  const char *pieces[] = {"1",   "-0.25", "12345678901234567890", "x",
+                          "1e5", "\xa0",  "\x89\x8a",            "+",
+                          " ",   ",",     "\n",                  "\r\n",
+                          "\t",  "                                   "};
+  for (size_t i = 0; i < 3000; i++) {
+    std::string input;
+    size_t length = size_t(rng(2 * i) % 300);
+    for (uint64_t h = rng(2 * i + 1); input.size() < length; h = rng(h)) {
+      input += pieces[h % 14];
+    }
+    check_index(input);
+  }
+  for (const char *s : {"", " ", "1", " 1", "1 ", ",,,,", "1,2", "1\n2\n"}) {
+    check_index(s);
+  }
+  for (size_t length = 60; length <= 130; length++) {
+    check_index(std::string(length, '7'));
+    check_index(std::string(length, ' ') + "7");
+    check_index("7" + std::string(length, ' '));
+  }
+  std::string input;
+  std::vector<double> expected;
+  for (size_t i = 1; i <= 2000; i++) {
+    double d;
+    uint64_t x = rng(i);
+    ::memcpy(&d, &x, sizeof(double));
+    if (!std::isfinite(d)) {
+      continue;
+    }
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), (i % 3 == 0) ? "%.17g\n" : "%.6g, ", d);
+    input += buffer;
+    expected.push_back(std::strtod(buffer, nullptr));
+  }
+  input += "0.5"; // not terminated
+  expected.push_back(0.5);
+  for (fast_double_parser::instruction_set set :
+       {fast_double_parser::instruction_set::scalar,
+        fast_double_parser::instruction_set::sse42,
+        fast_double_parser::instruction_set::avx2,
+        fast_double_parser::instruction_set::avx512}) {
+    if (!fast_double_parser::force_instruction_set(set)) {
+      continue;
+    }
+    for (size_t i = 0; i < 300; i++) {
+      std::string random;
+      size_t length = size_t(rng(3 * i) % 200);
+      for (uint64_t h = rng(3 * i + 1); random.size() < length; h = rng(h)) {
+        random += pieces[h % 14];
+      }
+      check_index(random);
+    }
+    // the second pass: bounded numbers parse as with parse_numbers
+    std::vector<char> buffer(input.begin(), input.end());
+    const char *begin = buffer.data();
+    const char *end = begin + buffer.size();
+    std::vector<const char *> starts(expected.size()), ends(expected.size());
+    size_t count;
+    if ((fast_double_parser::index_numbers(begin, end, starts.data(),
+                                           ends.data(), starts.size(),
+                                           &count) != end) ||
+        (count != expected.size())) {
+      throw std::runtime_error("bad index of numbers");
+    }
+    for (size_t i = 0; i < count; i++) {
+      double d;
+      if ((fast_double_parser::parse_bounded_number(starts[i], ends[i], end,
+                                                    &d) != ends[i]) ||
+          (double_bits(d) != double_bits(expected[i]))) {
+        throw std::runtime_error("bad bounded number");
+      }
+    }
+    double d;
+    std::string bad = "1.5 2e 0.25x 1e400";
+    const char *bad_end = bad.data() + bad.size();
+    if ((fast_double_parser::parse_bounded_number(bad.data() + 4,
+                                                  bad.data() + 6, bad_end,
+                                                  &d) != nullptr) ||
+        (fast_double_parser::parse_bounded_number(bad.data() + 7,
+                                                  bad.data() + 12, bad_end,
+                                                  &d) != nullptr) ||
+        (fast_double_parser::parse_bounded_number(bad.data() + 13, bad_end,
+                                                  bad_end, &d) != nullptr)) {
+      throw std::runtime_error("bad bounded number accepted");
+    }
+    std::cout << "number index ok with "
+              << fast_double_parser::instruction_set_name(set) << std::endl;
+  }
+  fast_double_parser::force_instruction_set(
+      fast_double_parser::instruction_set::automatic);
+}
+
+bool close_to(double x, double y, double tolerance) {
+  return std::fabs(x - y) <= tolerance * std::fabs(y);
+}
+
+void reductions() {
+  std::string input;
+  for (size_t i = 1; i <= 5000; i++) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), (i % 7 == 0) ? "%.3f,\t" : "%.3f\n",
+             double(int64_t(rng(i) % 2000000) - 1000000) / 1000);
+    input += buffer;
+  }
+  input += "999.5"; // not terminated
+  const char *begin = input.data();
+  const char *end = begin + input.size();
+  std::vector<double> values(input.size());
+  size_t count;
+  if (fast_double_parser::parse_numbers(begin, end, values.data(),
+                                        values.size(), &count) != end) {
+    throw std::runtime_error("cannot parse the reduction input");
+  }
+  values.resize(count);
+  double low = values[0], high = values[0], mean = 0, m2 = 0;
+  for (double x : values) {
+    low = std::min(low, x);
+    high = std::max(high, x);
+    mean += x;
+  }
+  mean /= double(count);
+  for (double x : values) {
+    m2 += (x - mean) * (x - mean);
+  }
+  fast_double_parser::histogram expected_histogram(-1000, 500, 12);
+  for (double x : values) {
+    expected_histogram.add(x);
+  }
+  for (fast_double_parser::instruction_set set :
+       {fast_double_parser::instruction_set::scalar,
+        fast_double_parser::instruction_set::sse42,
+        fast_double_parser::instruction_set::avx2,
+        fast_double_parser::instruction_set::avx512}) {
+    if (!fast_double_parser::force_instruction_set(set)) {
+      continue;
+    }
+    fast_double_parser::number_summary summary;
+    if ((fast_double_parser::reduce_numbers(begin, end, &summary, &count) !=
+         end) ||
+        (count != values.size()) || (summary.count() != values.size()) ||
+        (summary.minimum() != low) || (summary.maximum() != high) ||
+        !close_to(summary.mean(), mean, 1e-12) ||
+        !close_to(summary.sum(), mean * double(count), 1e-12) ||
+        !close_to(summary.variance(), m2 / double(count), 1e-12) ||
+        !close_to(summary.sample_variance(), m2 / double(count - 1), 1e-12)) {
+      throw std::runtime_error("bad summary");
+    }
+    // parts reduced on their own and merged give the same results
+    fast_double_parser::number_summary merged;
+    fast_double_parser::histogram merged_histogram(-1000, 500, 12);
+    const char *part = begin;
+    for (size_t k = 1; k <= 3; k++) {
+      const char *split = begin + input.size() * k / 3;
+      while ((split != end) && !fast_double_parser::is_separator(*split)) {
+        split++;
+      }
+      fast_double_parser::number_summary part_summary;
+      fast_double_parser::histogram part_histogram(-1000, 500, 12);
+      if ((fast_double_parser::reduce_numbers(part, split, &part_summary,
+                                              &count) != split) ||
+          (fast_double_parser::reduce_numbers(part, split, &part_histogram,
+                                              &count) != split) ||
+          !merged_histogram.merge(part_histogram)) {
+        throw std::runtime_error("bad partial reduction");
+      }
+      merged.merge(part_summary);
+      part = split;
+    }
+    if ((merged.count() != summary.count()) ||
+        (merged.minimum() != low) || (merged.maximum() != high) ||
+        !close_to(merged.sum(), summary.sum(), 1e-15) ||
+        !close_to(merged.variance(), summary.variance(), 1e-12)) {
+      throw std::runtime_error("bad merged summary");
+    }
+    for (size_t i = 0; i < expected_histogram.bin_count(); i++) {
+      if (merged_histogram.count(i) != expected_histogram.count(i)) {
+        throw std::runtime_error("bad merged histogram");
+      }
+    }
+    if ((merged_histogram.underflow() != expected_histogram.underflow()) ||
+        (merged_histogram.overflow() != expected_histogram.overflow()) ||
+        (expected_histogram.underflow() + expected_histogram.overflow() ==
+         0)) {
+      throw std::runtime_error("bad merged histogram");
+    }
+    // the values before a bad number are added
+    std::string bad = "1 2\t0.5x 3";
+    fast_double_parser::number_summary partial;
+    if ((fast_double_parser::reduce_numbers(bad.data(),
+                                            bad.data() + bad.size(), &partial,
+                                            &count) != bad.data() + 4) ||
+        (count != 2) || (partial.count() != 2) || (partial.sum() != 3)) {
+      throw std::runtime_error("reduction did not stop on a bad number");
+    }
+    std::cout << "reductions ok with "
+              << fast_double_parser::instruction_set_name(set) << std::endl;
+  }
+  fast_double_parser::force_instruction_set(
+      fast_double_parser::instruction_set::automatic);
+  // the sum is compensated: the ones are not lost
+  std::string ones = "1e16 1 1 1 1 -1e16";
+  fast_double_parser::number_summary summary;
+  if ((fast_double_parser::reduce_numbers(ones.data(),
+                                          ones.data() + ones.size(), &summary,
+                                          &count) !=
+       ones.data() + ones.size()) ||
+      (summary.sum() != 4)) {
+    throw std::runtime_error("bad compensated sum");
+  }
+  fast_double_parser::number_summary empty;
+  empty.merge(fast_double_parser::number_summary());
+  if ((empty.count() != 0) || !std::isnan(empty.mean()) ||
+      !std::isnan(empty.variance()) || (empty.minimum() <= empty.maximum())) {
+    throw std::runtime_error("bad empty summary");
+  }
+  // bounds: low goes to the first bin, high above the last one
+  fast_double_parser::histogram h(0, 1, 10);
+  h.add(0);
+  h.add(1);
+  h.add(0.99999999999999989);
+  h.add(-0.0);
+  h.add(-1e-300);
+  if ((h.count(0) != 2) || (h.count(9) != 1) || (h.overflow() != 1) ||
+      (h.underflow() != 1) || (h.bin_lower_bound(10) != 1) ||
+      h.merge(fast_double_parser::histogram(0, 1, 11))) {
+    throw std::runtime_error("bad histogram bounds");
+  }
+}
+
+#ifndef _WIN32
+void write_file(const std::string &path, const std::string &content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+}
+
+// Loads path through the cache and checks where the values came from.
+void check_cached(const std::string &path, const std::vector<double> &expected,
+                  bool from_cache) {
+  number_cache::cached_numbers numbers;
+  std::string error;
+  if (!numbers.load(path, &error)) {
+    throw std::runtime_error("cannot load through the cache: " + error);
+  }
+  if ((numbers.from_cache() != from_cache) ||
+      (std::vector<double>(numbers.data(), numbers.data() + numbers.size()) !=
+       expected)) {
+    throw std::runtime_error("bad cached load");
+  }
+}
+
+void number_cache_tests() {
+  char directory[] = "/tmp/fast_double_parser_cache_XXXXXX";
+  if (mkdtemp(directory) == nullptr) {
+    throw std::runtime_error("cannot create a temporary directory");
+  }
+  std::string path = std::string(directory) + "/numbers.txt";
+  std::string sidecar = number_cache::cached_numbers::sidecar_path(path);
+  write_file(path, "1.5\n-2e3\n0.25");
+  check_cached(path, {1.5, -2e3, 0.25}, false);
+  check_cached(path, {1.5, -2e3, 0.25}, true);
+  // same size, other content
+  write_file(path, "1.5\n-2e4\n0.25");
+  check_cached(path, {1.5, -2e4, 0.25}, false);
+  check_cached(path, {1.5, -2e4, 0.25}, true);
+  // a damaged sidecar is replaced
+  std::ifstream in(sidecar, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  in.close();
+  write_file(sidecar, bytes.substr(0, bytes.size() - 1));
+  check_cached(path, {1.5, -2e4, 0.25}, false);
+  bytes[8] = 2; // another version of the format
+  write_file(sidecar, bytes);
+  check_cached(path, {1.5, -2e4, 0.25}, false);
+  check_cached(path, {1.5, -2e4, 0.25}, true);
+  // the hash covers every byte, including a tail of fewer than 32 bytes
+  std::string text;
+  for (int i = 0; i < 1000; i++) {
+    text += std::to_string(i) + ((i % 10 == 9) ? "\n" : " ");
+  }
+  number_cache::content_hash original =
+      number_cache::hash_content(text.data(), text.size());
+  for (size_t i : {size_t(0), size_t(31), text.size() / 2, text.size() - 1}) {
+    std::string changed = text;
+    changed[i] ^= 1;
+    number_cache::content_hash hash =
+        number_cache::hash_content(changed.data(), changed.size());
+    if ((hash.low == original.low) && (hash.high == original.high)) {
+      throw std::runtime_error("the hash missed a change");
+    }
+  }
+  write_file(path, "");
+  check_cached(path, {}, false);
+  check_cached(path, {}, true);
+  // text that is not made of numbers is an error, and the sidecar stays
+  write_file(path, "1 2 three");
+  number_cache::cached_numbers numbers;
+  std::string error;
+  if (numbers.load(path, &error) || (error != "cannot parse 'three'") ||
+      (numbers.size() != 0)) {
+    throw std::runtime_error("bad text loaded through the cache");
+  }
+  unlink(sidecar.c_str());
+  unlink(path.c_str());
+  rmdir(directory);
+  std::cout << "number cache ok" << std::endl;
+}
+
+struct collecting_reducer {
+  std::vector<double> values;
+  void add(double x) { values.push_back(x); }
+};
+
+// Numbers cut anywhere by the buffers must be read whole, in order with a
+// single worker.
+void number_ingest_tests() {
+  char directory[] = "/tmp/fast_double_parser_ingest_XXXXXX";
+  if (mkdtemp(directory) == nullptr) {
+    throw std::runtime_error("cannot create a temporary directory");
+  }
+  std::string path = std::string(directory) + "/numbers.txt";
+  std::string text;
+  for (int i = 0; i < 300; i++) {
+    text += std::to_string(i * 7919 % 1000) + "." + std::to_string(i);
+    text += (i % 5 == 4) ? "\r\n" : (i % 3 == 0) ? ", " : " ";
+  }
+  text += "123456789012345678901234567890e-20,\t\tx1 -0.5\n\n2";
+  write_file(path, text);
+  std::vector<double> expected(1000);
+  size_t count;
+  const char *stop = fast_double_parser::parse_numbers(
+      text.data(), text.data() + text.size(), expected.data(),
+      expected.size(), &count);
+  expected.resize(count);
+  expected.push_back(-0.5); // after x1, which is skipped
+  expected.push_back(2);
+  if ((stop == text.data() + text.size()) || (*stop != 'x')) {
+    throw std::runtime_error("bad ingest test input");
+  }
+  for (number_ingest::read_method method :
+       {number_ingest::read_method::pread, number_ingest::read_method::io_uring}) {
+    for (size_t buffer_size : {1, 2, 3, 7, 16, 4096}) {
+      for (size_t workers : {1, 3}) {
+        number_ingest::ingest_options options;
+        options.buffer_size = buffer_size;
+        options.buffer_count = workers + 1;
+        options.method = method;
+        std::vector<collecting_reducer> reducers(workers);
+        number_ingest::ingest_result result;
+        std::string error;
+        if (!number_ingest::ingest_numbers(path, options, &reducers, &result,
+                                           &error)) {
+          if ((method == number_ingest::read_method::io_uring) &&
+              (error.find("io_uring is not available") == 0)) {
+            break;
+          }
+          throw std::runtime_error("cannot ingest: " + error);
+        }
+        std::vector<double> values;
+        for (const collecting_reducer &r : reducers) {
+          values.insert(values.end(), r.values.begin(), r.values.end());
+        }
+        std::vector<double> sorted = expected;
+        if (workers > 1) {
+          std::sort(values.begin(), values.end());
+          std::sort(sorted.begin(), sorted.end());
+        }
+        if ((values != sorted) || (result.error_count != 1) ||
+            (result.bytes != text.size()) || (result.method != method)) {
+          printf("ingest with %s, buffers of %zu, %zu workers\n",
+                 number_ingest::read_method_name(method), buffer_size,
+                 workers);
+          throw std::runtime_error("bad ingest");
+        }
+      }
+    }
+  }
+  // an empty file, and a missing one
+  write_file(path, "");
+  std::vector<collecting_reducer> reducers(2);
+  number_ingest::ingest_result result;
+  std::string error;
+  if (!number_ingest::ingest_numbers(path, number_ingest::ingest_options(),
+                                     &reducers, &result, &error) ||
+      !reducers[0].values.empty() || (result.bytes != 0)) {
+    throw std::runtime_error("bad ingest of an empty file");
+  }
+  unlink(path.c_str());
+  if (number_ingest::ingest_numbers(path, number_ingest::ingest_options(),
+                                    &reducers, &result, &error)) {
+    throw std::runtime_error("ingest of a missing file");
+  }
+  rmdir(directory);
+  std::cout << "number ingest ok" << std::endl;
+}
+#endif
+
+// The stream parser must agree with parse_numbers on any input, whether it
+// fits the learned shape or not.
+void check_stream(fast_double_parser::stream_parser *parser,
+                  const std::string &input, size_t capacity) {
+  std::vector<double> expected(capacity), values(capacity);
+  size_t expected_count, count;
+  const char *expected_end = fast_double_parser::parse_numbers(
+      input.data(), input.data() + input.size(), expected.data(), capacity,
+      &expected_count);
+  const char *end = parser->parse_numbers(input.data(),
+                                          input.data() + input.size(),
+                                          values.data(), capacity, &count);
+  if ((end != expected_end) || (count != expected_count)) {
+    printf("stream parsing of %s stopped at %zu, after %zu values\n",
+           input.c_str(), size_t(end - input.data()), count);
+    throw std::runtime_error("bad stream parsing");
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (double_bits(values[i]) != double_bits(expected[i])) {
+      printf("stream parsing of %s gave %.17g at %zu\n", input.c_str(),
+             values[i], i);
+      throw std::runtime_error("bad stream value");
+    }
+  }
+}
+
+void stream_parsing() {
+  using shape = fast_double_parser::stream_parser::shape;
+  struct stream {
+    const char *format;
+    shape learned;
+    int fraction_digits;
+  };
+  char buffer[64];
+  for (const stream &st : {stream{"%.6f", shape::fixed, 6},
+                           stream{"%.2f", shape::fixed, 2},
+                           stream{"%.8f", shape::fixed, 8},
+                           stream{"%.11f", shape::fixed, 11},
+                           stream{"%.16e", shape::scientific, 16},
+                           stream{"%.3E", shape::scientific, 3},
+                           stream{"%.0f", shape::integer, 0},
+                           stream{"%.17g", shape::generic, 0}}) {
+    std::vector<std::string> numbers;
+    for (size_t i = 1; i <= 10000; i++) {
+      uint64_t x = rng(i);
+      double d;
+      ::memcpy(&d, &x, sizeof(double));
+      if (st.learned != shape::scientific) {
+        // at most 8 digits before the period
+        d = double(int64_t(x)) / double(uint64_t(1) << (37 + i % 27));
+      }
+      if (std::isfinite(d)) {
+        snprintf(buffer, sizeof(buffer), st.format, d);
+        numbers.push_back(buffer);
+      }
+    }
+    // in pieces of various sizes, some not ending with a separator
+    fast_double_parser::stream_parser parser;
+    size_t i = 0;
+    for (size_t piece = 1; i < numbers.size(); piece = 2 * piece % 997) {
+      std::string input;
+      for (size_t j = 0; (j < piece) && (i < numbers.size()); j++, i++) {
+        input += numbers[i];
+        input += (i % 3 == 0) ? "\r\n" : ((i % 3 == 1) ? "," : " ");
+      }
+      if (piece % 2 == 1) {
+        input.pop_back();
+      }
+      check_stream(&parser, input, piece);
+    }
+    if ((parser.current_shape() != st.learned) ||
+        ((st.learned != shape::generic) &&
+         (parser.current_fraction_digits() != st.fraction_digits))) {
+      printf("stream %s: learned shape %d\n", st.format,
+             int(parser.current_shape()));
+      throw std::runtime_error("bad stream shape");
+    }
+    // numbers that do not fit the shape, or no number at all, in the middle
+    // of a learned stream or at its end
+    std::string before, after;
+    for (size_t j = 0; j < 40; j++) {
+      before += numbers[j] + "\n";
+      after += "\n" + numbers[j + 40];
+    }
+    for (const char *s :
+         {"0", "-0", "1.5", "-0.000000", "0.00", "01.000000", "01.00", "00",
+          "1.000000e5", "1.00e5", "1.0000000", "1234567890123.123456",
+          "12345678901234.123456", "12345678901234567.12",
+          "123456789012345678.12", "1.5e+308", "1.5e-400", "1.5e+1000",
+          "9.9999999999999999e+308", "4.9406564584124654e-324",
+          "2.4703282292062327e-324", "1.000e-", "1.000e", "1.000e+", "-",
+          "1.", ".5", "-.5", "1.0000000000000000e+0000",
+          "18446744073709551616", "9999999999999999999",
+          "10000000000000000000", "1e1", "1.000.5", "1.000x",
+          "1.2345678x", "1.23456789012345678", "-1.234567e-05x"}) {
+      check_stream(&parser, before + s + after, 100);
+      check_stream(&parser, before + s, 100);
+      check_stream(&parser, before + s + after, 40);
+    }
+  }
+  // a stream that changes shape is learned again
+  fast_double_parser::stream_parser parser;
+  std::string input;
+  for (size_t i = 0; i < 100; i++) {
+    input += std::to_string(i) + ".25\n";
+  }
+  for (size_t i = 0; i < 100; i++) {
+    input += std::to_string(i) + "\n";
+  }
+  check_stream(&parser, input, 200);
+  if ((parser.current_shape() != shape::integer) ||
+      (parser.mismatches() !=
+       fast_double_parser::stream_parser::resample_after)) {
+    throw std::runtime_error("stream shape not learned again");
+  }
+  parser.reset();
+  if (parser.current_shape() != shape::unknown) {
+    throw std::runtime_error("stream shape not reset");
+  }
+  std::cout << "stream parsing ok" << std::endl;
+}
+
+bool same_result(const char *end, double x, const char *expected_end,
+                 double expected) {
+  return (end == expected_end) &&
+         ((end == nullptr) || (memcmp(&x, &expected, sizeof(x)) == 0));
+}
+
+// parse_fixed must agree with parse_number on any input, whether it has the
+// expected format or not, and in a buffer that ends right after the number
+// or much later.
+template <int IntDigitsMax, int FracDigits>
+void check_fixed(const std::string &s) {
+  double expected = 0, x = 0;
+  const char *expected_end =
+      fast_double_parser::parse_number(s.c_str(), &expected);
+  const char *end =
+      fast_double_parser::parse_fixed<IntDigitsMax, FracDigits>(s.c_str(), &x);
+  bool ok = same_result(end, x, expected_end, expected);
+  for (const std::string &padding :
+       {std::string(), std::string("\n"), std::string(64, ' ')}) {
+    // exactly sized, so that the sanitizers catch reads beyond the end
+    std::vector<char> buffer(s.begin(), s.end());
+    buffer.insert(buffer.end(), padding.begin(), padding.end());
+    if (buffer.empty()) {
+      continue;
+    }
+    const char *begin = buffer.data();
+    end = fast_double_parser::parse_fixed<IntDigitsMax, FracDigits>(
+        begin, begin + buffer.size(), &x);
+    ok &= same_result(end, x,
+                      expected_end ? begin + (expected_end - s.c_str())
+                                   : nullptr,
+                      expected);
+  }
+  if (!ok) {
+    printf("parse_fixed<%d, %d> of '%s' failed\n", IntDigitsMax, FracDigits,
+           s.c_str());
+    throw std::runtime_error("bad fixed parsing");
+  }
+}
+
+template <int IntDigitsMax, int FracDigits> void check_fixed_format() {
+  char buffer[64];
+  for (size_t i = 1; i <= 2000; i++) {
+    // up to IntDigitsMax + 1 digits before the period
+    double limit = std::pow(10.0, IntDigitsMax + int(i % 2));
+    double d = double(int64_t(rng(i))) / 9223372036854775808.0 * limit;
+    snprintf(buffer, sizeof(buffer), "%.*f", FracDigits, d);
+    check_fixed<IntDigitsMax, FracDigits>(buffer);
+    // one fraction digit too many or too few
+    snprintf(buffer, sizeof(buffer), "%.*f", FracDigits + 1, d);
+    check_fixed<IntDigitsMax, FracDigits>(buffer);
+    if (FracDigits > 0) {
+      snprintf(buffer, sizeof(buffer), "%.*f", FracDigits - 1, d);
+      check_fixed<IntDigitsMax, FracDigits>(buffer);
+    }
+  }
+  for (const char *s :
+       {"0", "-0", "0.0", "-0.000000", "1.000000", "9.999999", "12.500000",
+        "1.50000", "1.5000000", "1.500000e5", "01.500000", "00", ".500000",
+        "1.", "-", "", "-.5", "1.50000x", "1.500000x", "1.500000,2",
+        "1.500000 2", "9999999999999999999", "99999999999999999999",
+        "9007199254740993", "9007199254740.993", "0.00000000000000000001",
+        "1.2345678901234567890",
+        // a sign after the number, at the end of the buffer or not
+        "0-1.5", "1.50-3", "1.500000+2", "-1.5-", "1e+", "1.500000e-"}) {
+    check_fixed<IntDigitsMax, FracDigits>(s);
+  }
+}
+
+void fixed_parsing() {
+  check_fixed_format<1, 6>();
+  check_fixed_format<3, 2>();
+  check_fixed_format<6, 0>();
+  check_fixed_format<1, 8>();
+  check_fixed_format<2, 9>();
+  check_fixed_format<4, 15>();
+  check_fixed_format<2, 16>();
+  check_fixed_format<1, 18>();
+  check_fixed_format<10, 9>();
+  check_fixed_format<19, 0>();
+  std::cout << "fixed parsing ok" << std::endl;
+}
 
 inline void Assert(bool Assertion) {
   if (!Assertion)
@@ -352,6 +1770,22 @@ int main() {
   issue50_fastpath();
   issue50_off_fastpath();
   issue23_2();
+  bulk_parse_all_instruction_sets();
+  trusted_parsing();
+  wide_code_units();
+  half_precision();
+  single_precision();
+  column_parsing();
+  lazy_parsing();
+  tagged_numbers();
+  stream_parsing();
+  fixed_parsing();
+  number_index();
+  reductions();
+#ifndef _WIN32
+  number_cache_tests();
+  number_ingest_tests();
+#endif
   unit_tests();
   for (int p = -306; p <= 308; p++) {
     if (p == 23)
@@ -395,6 +1829,9 @@ int main() {
     }
   }
   negative_subsubnormal_to_negative_zero();
+  subnormals();
+  out_of_range_exponents();
+  exact_midpoints();
   std::cout << std::endl;
   std::cout << "All ok" << std::endl;
   printf("Good!\n");
@@ -0,0 +1,327 @@
+// A cache of parsed number files, for jobs that load the same text files of
+// numbers over and over (POSIX only).
+//
+// The first load of a file parses it and writes its values to a binary
+// sidecar file; later loads map the sidecar instead of parsing again. The
+// sidecar is keyed on the content of the text file, not on its name or
+// modification time: it records a 128-bit hash of the text, which every
+// load recomputes (at several gigabytes per second, much faster than
+// parsing) and compares. A sidecar written for other content, by another
+// version of the format or on a machine of another byte order is ignored
+// and replaced.
+//
+// The hash is not cryptographic: it guards against stale caches, not
+// against someone crafting a text with the hash of another.
+//
+// Sidecar layout (little-endian), 64-byte header then the values:
+//   0  "FDPCACHE"
+//   8  format version (uint32), size of a value (uint32)
+//   16 size of the text (uint64)
+//   24 hash of the text (two uint64)
+//   40 number of values (uint64)
+//   48 reserved (zeros)
+//   64 the values, as binary64
+#ifndef FAST_DOUBLE_PARSER_NUMBER_CACHE_H
+#define FAST_DOUBLE_PARSER_NUMBER_CACHE_H
+
+#include "fast_double_parser.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace number_cache {
+
+const uint32_t format_version = 1;
+const size_t header_size = 64;
+const char magic[8] = {'F', 'D', 'P', 'C', 'A', 'C', 'H', 'E'};
+
+struct content_hash {
+  uint64_t low;
+  uint64_t high;
+};
+
+inline uint64_t rotate_left(uint64_t x, int bits) {
+  return (x << bits) | (x >> (64 - bits));
+}
+
+inline uint64_t finalize(uint64_t h) {
+  h ^= h >> 33;
+  h *= UINT64_C(0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  h *= UINT64_C(0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+  return h;
+}
+
+// Hashes [data, data + size) in chunks of 32 bytes, one 64-bit word per
+// lane so that the four lanes run in parallel, then folds the lanes and the
+// size into 128 bits.
+inline content_hash hash_content(const char *data, size_t size) {
+  const uint64_t k1 = UINT64_C(0x87c37b91114253d5);
+  const uint64_t k2 = UINT64_C(0x4cf5ad432745937f);
+  uint64_t lanes[4] = {UINT64_C(0x9e3779b97f4a7c15), UINT64_C(0xbf58476d1ce4e5b9),
+                       UINT64_C(0x94d049bb133111eb), UINT64_C(0x2545f4914f6cdd1d)};
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    for (int lane = 0; lane < 4; lane++) {
+      uint64_t word = fast_double_parser::load_little_endian_64(data + i +
+                                                                8 * lane);
+      lanes[lane] = rotate_left(lanes[lane] + word * k1, 31) * k2;
+    }
+  }
+  // the tail, padded with zeros: the size tells it apart
+  char tail[32] = {};
+  memcpy(tail, data + i, size - i);
+  for (int lane = 0; lane < 4; lane++) {
+    uint64_t word = fast_double_parser::load_little_endian_64(tail + 8 * lane);
+    lanes[lane] = rotate_left(lanes[lane] + word * k1, 31) * k2;
+  }
+  content_hash hash;
+  hash.low = finalize(lanes[0] ^ rotate_left(lanes[1], 17) ^ uint64_t(size));
+  hash.high = finalize(lanes[2] ^ rotate_left(lanes[3], 17) ^ hash.low);
+  return hash;
+}
+
+inline bool is_little_endian() {
+  uint16_t x = 1;
+  unsigned char first;
+  memcpy(&first, &x, 1);
+  return first == 1;
+}
+
+// A read-only mapping of a whole file.
+class mapped_file {
+public:
+  mapped_file() : data_(nullptr), size_(0) {}
+  ~mapped_file() { unmap(); }
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  // Returns false, with errno set, if the file cannot be mapped.
+  bool map(const std::string &path) {
+    unmap();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      int saved = errno;
+      close(fd);
+      errno = saved;
+      return false;
+    }
+    size_ = size_t(st.st_size);
+    if (size_ > 0) {
+      void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        int saved = errno;
+        close(fd);
+        size_ = 0;
+        errno = saved;
+        return false;
+      }
+      data_ = static_cast<const char *>(mapping);
+    }
+    close(fd);
+    return true;
+  }
+
+  void unmap() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  // never null, even for an empty file
+  const char *data() const { return (data_ != nullptr) ? data_ : ""; }
+  size_t size() const { return size_; }
+
+private:
+  const char *data_;
+  size_t size_;
+};
+
+// The values of a text file of numbers, loaded through its sidecar.
+class cached_numbers {
+public:
+  cached_numbers() : count_(0), from_cache_(false) {}
+  cached_numbers(const cached_numbers &) = delete;
+  cached_numbers &operator=(const cached_numbers &) = delete;
+
+  // The sidecar of a text file, next to it.
+  static std::string sidecar_path(const std::string &path) {
+    return path + ".fdpcache";
+  }
+
+  // Loads the numbers of the text file at path, one per line or separated
+  // by white space or commas. The sidecar is used if it matches the text;
+  // otherwise the text is parsed and the sidecar is written, if possible
+  // (a sidecar that cannot be written is not an error). Returns false, with
+  // a message in *error, if the text cannot be read or holds something
+  // other than numbers.
+  bool load(const std::string &path, const std::string &sidecar,
+            std::string *error) {
+    values_.clear();
+    sidecar_file_.unmap();
+    count_ = 0;
+    from_cache_ = false;
+    mapped_file text;
+    if (!text.map(path)) {
+      *error = "cannot read " + path + ": " + strerror(errno);
+      return false;
+    }
+    content_hash hash = hash_content(text.data(), text.size());
+    if (map_sidecar(sidecar, text.size(), hash)) {
+      from_cache_ = true;
+      return true;
+    }
+    if (!parse(text, error)) {
+      return false;
+    }
+    write_sidecar(sidecar, text.size(), hash);
+    return true;
+  }
+
+  bool load(const std::string &path, std::string *error) {
+    return load(path, sidecar_path(path), error);
+  }
+
+  const double *data() const {
+    return from_cache_ ? reinterpret_cast<const double *>(
+                             sidecar_file_.data() + header_size)
+                       : values_.data();
+  }
+  size_t size() const { return count_; }
+  // whether the values come from the sidecar
+  bool from_cache() const { return from_cache_; }
+
+private:
+  bool parse(const mapped_file &text, std::string *error) {
+    const char *p = text.data();
+    const char *end = p + text.size();
+    const size_t block = size_t(1) << 16;
+    while (p != end) {
+      size_t old_size = values_.size();
+      values_.resize(old_size + block);
+      size_t count;
+      const char *stop = fast_double_parser::parse_numbers(
+          p, end, values_.data() + old_size, block, &count);
+      values_.resize(old_size + count);
+      if ((stop != end) && (count != block)) {
+        const char *token_end = stop;
+        while ((token_end != end) && (token_end - stop < 40) &&
+               !fast_double_parser::is_separator(*token_end)) {
+          token_end++;
+        }
+        *error = "cannot parse '" + std::string(stop, token_end) + "'";
+        values_.clear();
+        return false;
+      }
+      p = stop;
+    }
+    count_ = values_.size();
+    return true;
+  }
+
+  bool map_sidecar(const std::string &sidecar, size_t text_size,
+                   content_hash hash) {
+    if (!is_little_endian() || !sidecar_file_.map(sidecar)) {
+      return false;
+    }
+    const char *header = sidecar_file_.data();
+    size_t size = sidecar_file_.size();
+    uint32_t version, value_size;
+    uint64_t recorded_size, count;
+    content_hash recorded;
+    if (size < header_size) {
+      sidecar_file_.unmap();
+      return false;
+    }
+    memcpy(&version, header + 8, 4);
+    memcpy(&value_size, header + 12, 4);
+    memcpy(&recorded_size, header + 16, 8);
+    memcpy(&recorded.low, header + 24, 8);
+    memcpy(&recorded.high, header + 32, 8);
+    memcpy(&count, header + 40, 8);
+    if ((memcmp(header, magic, sizeof(magic)) != 0) ||
+        (version != format_version) || (value_size != sizeof(double)) ||
+        (recorded_size != text_size) || (recorded.low != hash.low) ||
+        (recorded.high != hash.high) ||
+        (count != (size - header_size) / sizeof(double)) ||
+        ((size - header_size) % sizeof(double) != 0)) {
+      sidecar_file_.unmap();
+      return false;
+    }
+    count_ = size_t(count);
+    return true;
+  }
+
+  // Writes a temporary file then renames it, so that concurrent loads
+  // never see a partial sidecar.
+  void write_sidecar(const std::string &sidecar, size_t text_size,
+                     content_hash hash) {
+    if (!is_little_endian()) {
+      return;
+    }
+    char header[header_size] = {};
+    uint32_t value_size = sizeof(double);
+    uint64_t size = text_size;
+    uint64_t count = values_.size();
+    memcpy(header, magic, sizeof(magic));
+    memcpy(header + 8, &format_version, 4);
+    memcpy(header + 12, &value_size, 4);
+    memcpy(header + 16, &size, 8);
+    memcpy(header + 24, &hash.low, 8);
+    memcpy(header + 32, &hash.high, 8);
+    memcpy(header + 40, &count, 8);
+    std::string temporary = sidecar + ".tmp." + std::to_string(getpid());
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return;
+    }
+    bool written =
+        write_all(fd, header, header_size) &&
+        write_all(fd, reinterpret_cast<const char *>(values_.data()),
+                  values_.size() * sizeof(double));
+    if ((close(fd) != 0) || !written ||
+        (rename(temporary.c_str(), sidecar.c_str()) != 0)) {
+      unlink(temporary.c_str());
+    }
+  }
+
+  static bool write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+      ssize_t written = write(fd, data, size);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      data += written;
+      size -= size_t(written);
+    }
+    return true;
+  }
+
+  std::vector<double> values_;
+  mapped_file sidecar_file_;
+  size_t count_;
+  bool from_cache_;
+};
+
+} // namespace number_cache
+
+#endif // FAST_DOUBLE_PARSER_NUMBER_CACHE_H
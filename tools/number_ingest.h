@@ -0,0 +1,591 @@
+// Reads a text file of numbers into a ring of buffers while worker threads
+// parse the buffers already read (POSIX only).
+//
+// Mapping a file and parsing it reads the file page by page, on demand:
+// on a cold cache the parser waits for the disk, then the disk waits for
+// the parser. Here the main thread keeps several large reads in flight
+// (with io_uring on Linux, or one pread at a time elsewhere or when
+// io_uring is not available) and hands each buffer, as soon as it is read,
+// to the workers, which reduce its numbers with reduce_numbers. The time
+// to ingest a file is then close to the larger of the time to read it and
+// the time to parse it, rather than their sum.
+//
+// A number cut at the end of a buffer is completed by the main thread,
+// which copies its two parts into a small string parsed along with the
+// next buffer: the workers only see whole numbers.
+#ifndef FAST_DOUBLE_PARSER_NUMBER_INGEST_H
+#define FAST_DOUBLE_PARSER_NUMBER_INGEST_H
+
+#include "fast_double_parser.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#define FAST_DOUBLE_PARSER_IO_URING 1
+#endif
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace number_ingest {
+
+enum class read_method {
+  automatic, // io_uring if available, pread otherwise
+  io_uring,
+  pread
+};
+
+inline const char *read_method_name(read_method method) {
+  switch (method) {
+  case read_method::io_uring:
+    return "io_uring";
+  case read_method::pread:
+    return "pread";
+  default:
+    return "automatic";
+  }
+}
+
+// Reads parts of a file into caller-owned buffers, several at a time with
+// io_uring. Each read is identified by a slot in [0, slot_count); a slot
+// completes once its read is complete, short reads being resumed.
+class file_reader {
+public:
+  file_reader() : fd_(-1), size_(0), method_(read_method::pread) {}
+  ~file_reader() { close_file(); }
+  file_reader(const file_reader &) = delete;
+  file_reader &operator=(const file_reader &) = delete;
+
+  // Returns false, with a message in *error, if the file cannot be opened
+  // or if io_uring is required but not available.
+  bool open(const std::string &path, read_method method, size_t slot_count,
+            std::string *error) {
+    close_file();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if ((fd_ < 0) || (fstat(fd_, &st) != 0)) {
+      *error = "cannot read " + path + ": " + strerror(errno);
+      close_file();
+      return false;
+    }
+    size_ = uint64_t(st.st_size);
+    reads_.assign(slot_count, pending_read());
+    method_ = read_method::pread;
+    if (method != read_method::pread) {
+      if (ring_.setup(unsigned(slot_count))) {
+        method_ = read_method::io_uring;
+      } else if (method == read_method::io_uring) {
+        *error = std::string("io_uring is not available: ") + strerror(errno);
+        close_file();
+        return false;
+      }
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return true;
+  }
+
+  uint64_t size() const { return size_; }
+  read_method method() const { return method_; }
+
+  // Starts reading size bytes at offset into buffer.
+  bool submit(size_t slot, char *buffer, size_t size, uint64_t offset,
+              std::string *error) {
+    pending_read &read = reads_[slot];
+    read.buffer = buffer;
+    read.size = size;
+    read.done = 0;
+    read.offset = offset;
+    if (method_ == read_method::pread) {
+      waiting_.push_back(slot);
+      return true;
+    }
+    return submit_to_ring(slot, error);
+  }
+
+  // Waits until a read completes, and returns its slot in *slot. On an
+  // error, *slot is the failed read if known (and slot_count otherwise).
+  bool wait(size_t *slot, std::string *error) {
+    *slot = reads_.size();
+    if (method_ == read_method::pread) {
+      // the reads are done here, in order
+      *slot = waiting_.front();
+      waiting_.pop_front();
+      pending_read &read = reads_[*slot];
+      while (read.done < read.size) {
+        ssize_t got = ::pread(fd_, read.buffer + read.done,
+                              read.size - read.done,
+                              off_t(read.offset + read.done));
+        if ((got < 0) && (errno == EINTR)) {
+          continue;
+        }
+        if (!advance(read, got, error)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return wait_on_ring(slot, error);
+  }
+
+private:
+  struct pending_read {
+    char *buffer;
+    size_t size;
+    size_t done;
+    uint64_t offset;
+#ifdef FAST_DOUBLE_PARSER_IO_URING
+    struct iovec vector;
+#endif
+  };
+
+  // Records got bytes read (or -1 with errno set).
+  static bool advance(pending_read &read, ssize_t got, std::string *error) {
+    if (got < 0) {
+      *error = std::string("cannot read: ") + strerror(errno);
+      return false;
+    }
+    if (got == 0) {
+      *error = "the file was truncated while being read";
+      return false;
+    }
+    read.done += size_t(got);
+    return true;
+  }
+
+#ifdef FAST_DOUBLE_PARSER_IO_URING
+  // A submission and a completion queue shared with the kernel, without
+  // liburing.
+  class ring {
+  public:
+    ring() : fd_(-1) {}
+    ~ring() { destroy(); }
+    ring(const ring &) = delete;
+    ring &operator=(const ring &) = delete;
+
+    bool setup(unsigned entries) {
+      destroy();
+      struct io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      fd_ = int(syscall(__NR_io_uring_setup, entries, &params));
+      if (fd_ < 0) {
+        return false;
+      }
+      sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_size_ = params.cq_off.cqes +
+                 params.cq_entries * sizeof(struct io_uring_cqe);
+      single_mapping_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (single_mapping_ && (cq_size_ > sq_size_)) {
+        sq_size_ = cq_size_;
+      }
+      sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+      sq_ = map(sq_size_, IORING_OFF_SQ_RING);
+      cq_ = single_mapping_ ? sq_ : map(cq_size_, IORING_OFF_CQ_RING);
+      sqes_ = static_cast<struct io_uring_sqe *>(
+          map(sqes_size_, IORING_OFF_SQES));
+      if ((sq_ == nullptr) || (cq_ == nullptr) || (sqes_ == nullptr)) {
+        int saved = errno;
+        destroy();
+        errno = saved;
+        return false;
+      }
+      sq_tail_ = field(sq_, params.sq_off.tail);
+      sq_mask_ = *field(sq_, params.sq_off.ring_mask);
+      sq_array_ = field(sq_, params.sq_off.array);
+      cq_head_ = field(cq_, params.cq_off.head);
+      cq_tail_ = field(cq_, params.cq_off.tail);
+      cq_mask_ = *field(cq_, params.cq_off.ring_mask);
+      cqes_ = reinterpret_cast<struct io_uring_cqe *>(
+          static_cast<char *>(cq_) + params.cq_off.cqes);
+      return true;
+    }
+
+    // Queues a vectored read and submits it.
+    bool read(int fd, const struct iovec *vector, uint64_t offset,
+              uint64_t user_data) {
+      unsigned tail = *sq_tail_; // we are the only producer
+      unsigned index = tail & sq_mask_;
+      struct io_uring_sqe *sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = fd;
+      sqe->off = offset;
+      sqe->addr = uint64_t(uintptr_t(vector));
+      sqe->len = 1;
+      sqe->user_data = user_data;
+      sq_array_[index] = index;
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      while (syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0) < 0) {
+        if (errno != EINTR) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Waits for a completion; *result is the number of bytes or -errno.
+    bool complete(uint64_t *user_data, int *result) {
+      unsigned head = *cq_head_;
+      while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        if ((syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                     nullptr, 0) < 0) &&
+            (errno != EINTR)) {
+          return false;
+        }
+      }
+      const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+      *user_data = cqe.user_data;
+      *result = cqe.res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    void destroy() {
+      if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+      }
+      if ((cq_ != nullptr) && (cq_ != sq_)) {
+        munmap(cq_, cq_size_);
+      }
+      if (sq_ != nullptr) {
+        munmap(sq_, sq_size_);
+      }
+      sq_ = cq_ = nullptr;
+      sqes_ = nullptr;
+      if (fd_ >= 0) {
+        close(fd_);
+      }
+      fd_ = -1;
+    }
+
+  private:
+    void *map(size_t size, off_t offset) {
+      void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd_, offset);
+      return (mapping == MAP_FAILED) ? nullptr : mapping;
+    }
+
+    static unsigned *field(void *base, uint32_t offset) {
+      return reinterpret_cast<unsigned *>(static_cast<char *>(base) + offset);
+    }
+
+    int fd_;
+    void *sq_ = nullptr;
+    void *cq_ = nullptr;
+    struct io_uring_sqe *sqes_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    bool single_mapping_ = false;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe *cqes_ = nullptr;
+  };
+
+  bool submit_to_ring(size_t slot, std::string *error) {
+    pending_read &read = reads_[slot];
+    read.vector.iov_base = read.buffer + read.done;
+    read.vector.iov_len = read.size - read.done;
+    if (!ring_.read(fd_, &read.vector, read.offset + read.done, slot)) {
+      *error = std::string("cannot submit a read: ") + strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  bool wait_on_ring(size_t *slot, std::string *error) {
+    for (;;) {
+      uint64_t user_data;
+      int result;
+      if (!ring_.complete(&user_data, &result)) {
+        *error = std::string("cannot wait for a read: ") + strerror(errno);
+        return false;
+      }
+      *slot = size_t(user_data);
+      pending_read &read = reads_[*slot];
+      if ((result == -EINTR) || (result == -EAGAIN)) {
+        result = 0;
+      } else {
+        if (result < 0) {
+          errno = -result;
+        }
+        if (!advance(read, result, error)) {
+          return false;
+        }
+      }
+      if (read.done == read.size) {
+        return true;
+      }
+      if (!submit_to_ring(*slot, error)) {
+        return false;
+      }
+    }
+  }
+#else
+  struct ring {
+    bool setup(unsigned) {
+      errno = ENOSYS;
+      return false;
+    }
+    void destroy() {}
+  };
+
+  bool submit_to_ring(size_t, std::string *) { return false; }
+  bool wait_on_ring(size_t *, std::string *) { return false; }
+#endif
+
+  void close_file() {
+    ring_.destroy();
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    fd_ = -1;
+    waiting_.clear();
+  }
+
+  int fd_;
+  uint64_t size_;
+  read_method method_;
+  ring ring_;
+  std::vector<pending_read> reads_;
+  std::deque<size_t> waiting_; // with pread
+};
+
+struct ingest_options {
+  size_t buffer_size = size_t(1) << 20;
+  // buffers in the ring: those not being parsed are being read
+  size_t buffer_count = 8;
+  read_method method = read_method::automatic;
+};
+
+struct ingest_result {
+  uint64_t bytes = 0;
+  // numbers that could not be parsed, skipped
+  size_t error_count = 0;
+  read_method method = read_method::pread;
+};
+
+// Reads the numbers of the text file at path, one per line or separated by
+// white space or commas, with one worker thread per reducer: each number is
+// added to one of the reducers, which the caller then merges. Numbers that
+// cannot be parsed are skipped and counted. Returns false, with a message
+// in *error, if the file cannot be read.
+template <typename Reducer>
+bool ingest_numbers(const std::string &path, const ingest_options &options,
+                    std::vector<Reducer> *reducers, ingest_result *result,
+                    std::string *error) {
+  struct task {
+    int buffer; // -1 if none
+    const char *begin;
+    const char *end;
+    std::string boundary; // the number cut at the end of the last buffer
+  };
+  const size_t buffer_size = options.buffer_size > 0 ? options.buffer_size : 1;
+  const size_t buffer_count =
+      options.buffer_count > 0 ? options.buffer_count : 1;
+  file_reader reader;
+  if (reducers->empty() ||
+      !reader.open(path, options.method, buffer_count, error)) {
+    if (reducers->empty()) {
+      *error = "no reducer";
+    }
+    return false;
+  }
+  result->bytes = reader.size();
+  result->error_count = 0;
+  result->method = reader.method();
+  std::unique_ptr<char[]> memory(new char[buffer_size * buffer_count]);
+
+  std::mutex mutex;
+  std::condition_variable tasks_ready;
+  std::condition_variable buffers_freed;
+  std::deque<task> tasks;
+  std::vector<size_t> free_buffers;
+  for (size_t b = buffer_count; b > 0; b--) {
+    free_buffers.push_back(b - 1);
+  }
+  bool finished = false;
+  std::vector<size_t> error_counts(reducers->size(), 0);
+
+  auto reduce_range = [](const char *p, const char *end, Reducer *reducer,
+                         size_t *error_count) {
+    while (p != end) {
+      size_t count;
+      p = fast_double_parser::reduce_numbers(p, end, reducer, &count);
+      if (p == end) {
+        break;
+      }
+      // p is at a number that could not be parsed: we skip it
+      (*error_count)++;
+      while ((p != end) && !fast_double_parser::is_separator(*p)) {
+        p++;
+      }
+    }
+  };
+  auto work = [&](size_t worker) {
+    Reducer *reducer = &(*reducers)[worker];
+    for (;;) {
+      task t;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        tasks_ready.wait(lock, [&] { return finished || !tasks.empty(); });
+        if (tasks.empty()) {
+          return;
+        }
+        t = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      reduce_range(t.boundary.data(), t.boundary.data() + t.boundary.size(),
+                   reducer, &error_counts[worker]);
+      reduce_range(t.begin, t.end, reducer, &error_counts[worker]);
+      if (t.buffer >= 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_buffers.push_back(size_t(t.buffer));
+        buffers_freed.notify_one();
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < reducers->size(); w++) {
+    workers.emplace_back(work, w);
+  }
+  auto push = [&](task t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(t));
+    tasks_ready.notify_one();
+  };
+
+  const uint64_t size = reader.size();
+  const uint64_t block_count = (size + buffer_size - 1) / buffer_size;
+  // the buffers being read, in the order of the file
+  std::deque<size_t> reading;
+  std::vector<bool> read_done(buffer_count, false);
+  uint64_t next_read = 0;
+  std::string carry;
+  bool ok = true;
+  for (uint64_t block = 0; ok && (block < block_count); block++) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (reading.empty()) {
+        buffers_freed.wait(lock, [&] { return !free_buffers.empty(); });
+      }
+      while (!free_buffers.empty() && (next_read < block_count)) {
+        size_t b = free_buffers.back();
+        free_buffers.pop_back();
+        uint64_t offset = next_read * buffer_size;
+        size_t length = size_t(std::min<uint64_t>(buffer_size, size - offset));
+        read_done[b] = false;
+        lock.unlock();
+        ok = reader.submit(b, memory.get() + b * buffer_size, length, offset,
+                           error);
+        lock.lock();
+        if (!ok) {
+          break;
+        }
+        reading.push_back(b);
+        next_read++;
+      }
+    }
+    if (!ok) {
+      // reading may be empty
+      break;
+    }
+    size_t b = reading.front();
+    while (ok && !read_done[b]) {
+      size_t slot;
+      ok = reader.wait(&slot, error);
+      if (slot < buffer_count) {
+        read_done[slot] = true;
+      }
+    }
+    if (!ok) {
+      break;
+    }
+    reading.pop_front();
+    const char *begin = memory.get() + b * buffer_size;
+    const uint64_t offset = block * buffer_size;
+    const char *end =
+        begin + size_t(std::min<uint64_t>(buffer_size, size - offset));
+    bool last = (block + 1 == block_count);
+    // the number cut at the start of the buffer goes with the carry
+    const char *head = begin;
+    while ((head != end) && !fast_double_parser::is_separator(*head)) {
+      head++;
+    }
+    if ((head == end) && !last) {
+      // a single number, or part of one, spans the whole buffer
+      carry.append(begin, end);
+      std::lock_guard<std::mutex> lock(mutex);
+      free_buffers.push_back(b);
+      continue;
+    }
+    task t;
+    t.buffer = int(b);
+    t.boundary = carry;
+    t.boundary.append(begin, head);
+    t.begin = head;
+    t.end = end;
+    carry.clear();
+    if (!last) {
+      // the number cut at the end waits for the next buffer
+      while (!fast_double_parser::is_separator(*(t.end - 1))) {
+        t.end--;
+      }
+      carry.assign(t.end, end);
+    }
+    push(std::move(t));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    tasks_ready.notify_all();
+  }
+  // on an error, io_uring reads may still be in flight: wait for them,
+  // since they target our buffers
+  size_t in_flight = 0;
+  if (!ok && (reader.method() == read_method::io_uring)) {
+    for (size_t b : reading) {
+      in_flight += read_done[b] ? 0 : 1;
+    }
+  }
+  for (; in_flight > 0; in_flight--) {
+    size_t slot;
+    std::string ignored;
+    if (!reader.wait(&slot, &ignored) && (slot == buffer_count)) {
+      break;
+    }
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  for (size_t count : error_counts) {
+    result->error_count += count;
+  }
+  return ok;
+}
+
+} // namespace number_ingest
+
+#endif // FAST_DOUBLE_PARSER_NUMBER_INGEST_H
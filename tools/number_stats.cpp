@@ -0,0 +1,317 @@
+// Prints statistics of a text file of numbers, one per line or in a few
+// columns separated by white space or commas: their count, minimum,
+// maximum, sum, mean and standard deviation, and optionally a histogram.
+//
+// usage: number_stats [-t <threads>] [-H <low>,<high>,<bins>]
+//                     [-r <method>] <input>
+//   -t  number of threads (default: all cores)
+//   -H  also count the values in <bins> bins of equal width over
+//       [<low>, <high>)
+//   -r  read the input into a ring of buffers with <method> (io_uring,
+//       pread or auto), parsing while reading, rather than mapping it
+//
+// The input is mapped in memory and split between the threads at
+// separators (or, with -r, read with number_ingest.h). Each thread folds
+// its part into a number_summary (and a histogram) with reduce_numbers,
+// without storing the values, and the partial states are then merged. Numbers that cannot be parsed (including
+// values too large for a double) are skipped and counted. Statistics go to
+// stdout, timings to stderr; the exit status is 1 if any number could not
+// be parsed.
+#include "fast_double_parser.h"
+#include "number_ingest.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct histogram_layout {
+  bool enabled;
+  double low;
+  double high;
+  size_t bins;
+};
+
+struct chunk {
+  const char *begin;
+  const char *end;
+  fast_double_parser::number_summary summary;
+  fast_double_parser::histogram histogram;
+  size_t error_count;
+};
+
+// Adds each value to both a summary and a histogram.
+struct summary_and_histogram {
+  fast_double_parser::number_summary *summary;
+  fast_double_parser::histogram *histogram;
+  void add(double x) {
+    summary->add(x);
+    histogram->add(x);
+  }
+};
+
+template <typename Reducer> void reduce_chunk(chunk *c, Reducer *reducer) {
+  const char *p = c->begin;
+  while (p != c->end) {
+    size_t count;
+    p = fast_double_parser::reduce_numbers(p, c->end, reducer, &count);
+    if (p == c->end) {
+      break;
+    }
+    // p is at a number that could not be parsed: we skip it
+    c->error_count++;
+    while ((p != c->end) && !fast_double_parser::is_separator(*p)) {
+      p++;
+    }
+  }
+}
+
+void parse_chunk(chunk *c, bool with_histogram) {
+  if (with_histogram) {
+    summary_and_histogram both = {&c->summary, &c->histogram};
+    reduce_chunk(c, &both);
+  } else {
+    reduce_chunk(c, &c->summary);
+  }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void print_summary(const fast_double_parser::number_summary &summary,
+                   const fast_double_parser::histogram &histogram,
+                   const histogram_layout &layout) {
+  printf("count     %" PRIu64 "\n", summary.count());
+  printf("minimum   %.17g\n", summary.minimum());
+  printf("maximum   %.17g\n", summary.maximum());
+  printf("sum       %.17g\n", summary.sum());
+  printf("mean      %.17g\n", summary.mean());
+  printf("std. dev. %.17g\n", std::sqrt(summary.sample_variance()));
+  if (layout.enabled) {
+    printf("below     %" PRIu64 "\n", histogram.underflow());
+    for (size_t i = 0; i < histogram.bin_count(); i++) {
+      printf("[%.6g, %.6g) %" PRIu64 "\n", histogram.bin_lower_bound(i),
+             histogram.bin_lower_bound(i + 1), histogram.count(i));
+    }
+    printf("above     %" PRIu64 "\n", histogram.overflow());
+  }
+}
+
+int print_stats(const char *data, size_t size, size_t thread_count,
+                const histogram_layout &layout) {
+  auto start = std::chrono::steady_clock::now();
+  // each part starts at a separator, or at the start of the input
+  std::vector<chunk> chunks(
+      thread_count, chunk{nullptr, nullptr, fast_double_parser::number_summary(),
+                          fast_double_parser::histogram(
+                              layout.low, layout.high, layout.bins),
+                          0});
+  const char *end = data + size;
+  const char *p = data;
+  for (size_t t = 0; t < thread_count; t++) {
+    const char *split = data + size * (t + 1) / thread_count;
+    if (split < p) {
+      split = p;
+    }
+    while ((split != end) && !fast_double_parser::is_separator(*split)) {
+      split++;
+    }
+    chunks[t].begin = p;
+    chunks[t].end = split;
+    p = split;
+  }
+  std::vector<std::thread> threads;
+  for (chunk &c : chunks) {
+    threads.emplace_back(parse_chunk, &c, layout.enabled);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  fast_double_parser::number_summary summary;
+  fast_double_parser::histogram histogram(layout.low, layout.high,
+                                          layout.bins);
+  size_t error_count = 0;
+  for (chunk &c : chunks) {
+    summary.merge(c.summary);
+    if (!histogram.merge(c.histogram)) {
+      fprintf(stderr, "histograms do not match\n");
+      return EXIT_FAILURE;
+    }
+    error_count += c.error_count;
+  }
+  double parse_time = seconds_since(start);
+
+  print_summary(summary, histogram, layout);
+  fprintf(stderr, "%zu bytes, %zu errors, %zu threads\n", size, error_count,
+          thread_count);
+  fprintf(stderr, "%.3f s, %.2f MB/s, %.2f Mnumbers/s\n", parse_time,
+          double(size) / parse_time / 1e6,
+          double(summary.count()) / parse_time / 1e6);
+  return error_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Reads the input while parsing it, each thread folding the buffers it
+// gets into its own reducers.
+int ingest_stats(const char *input, size_t thread_count,
+                 const histogram_layout &layout,
+                 number_ingest::read_method method) {
+  auto start = std::chrono::steady_clock::now();
+  number_ingest::ingest_options options;
+  options.method = method;
+  // as many buffers being read as being parsed
+  options.buffer_count = 2 * thread_count + 2;
+  number_ingest::ingest_result result;
+  std::string error;
+  fast_double_parser::number_summary summary;
+  fast_double_parser::histogram histogram(layout.low, layout.high,
+                                          layout.bins);
+  bool ok;
+  if (layout.enabled) {
+    std::vector<fast_double_parser::number_summary> summaries(thread_count);
+    std::vector<fast_double_parser::histogram> histograms(thread_count,
+                                                          histogram);
+    std::vector<summary_and_histogram> reducers;
+    for (size_t t = 0; t < thread_count; t++) {
+      reducers.push_back({&summaries[t], &histograms[t]});
+    }
+    ok = number_ingest::ingest_numbers(input, options, &reducers, &result,
+                                       &error);
+    for (size_t t = 0; t < thread_count; t++) {
+      summary.merge(summaries[t]);
+      if (!histogram.merge(histograms[t])) {
+        fprintf(stderr, "histograms do not match\n");
+        return EXIT_FAILURE;
+      }
+    }
+  } else {
+    std::vector<fast_double_parser::number_summary> summaries(thread_count);
+    ok = number_ingest::ingest_numbers(input, options, &summaries, &result,
+                                       &error);
+    for (const fast_double_parser::number_summary &s : summaries) {
+      summary.merge(s);
+    }
+  }
+  if (!ok) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+  double time = seconds_since(start);
+
+  print_summary(summary, histogram, layout);
+  fprintf(stderr, "%" PRIu64 " bytes, %zu errors, %zu threads, %s\n",
+          result.bytes, result.error_count, thread_count,
+          number_ingest::read_method_name(result.method));
+  fprintf(stderr, "%.3f s, %.2f MB/s, %.2f Mnumbers/s\n", time,
+          double(result.bytes) / time / 1e6,
+          double(summary.count()) / time / 1e6);
+  return result.error_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-t <threads>] [-H <low>,<high>,<bins>] [-r <method>] "
+          "<input>\n",
+          name);
+  fprintf(stderr, "  -t  number of threads (default: all cores)\n");
+  fprintf(stderr, "  -H  also count the values in <bins> bins of equal width "
+                  "over [<low>, <high>)\n");
+  fprintf(stderr, "  -r  read the input into a ring of buffers with <method> "
+                  "(io_uring, pread or auto), parsing while reading\n");
+}
+
+int main(int argc, char **argv) {
+  size_t thread_count = std::thread::hardware_concurrency();
+  histogram_layout layout = {false, 0, 1, 1};
+  bool ingest = false;
+  number_ingest::read_method method = number_ingest::read_method::automatic;
+  int c;
+  while ((c = getopt(argc, argv, "t:H:r:")) != -1) {
+    switch (c) {
+    case 't':
+      thread_count = size_t(strtoull(optarg, nullptr, 10));
+      break;
+    case 'H': {
+      unsigned long long bins;
+      if ((sscanf(optarg, "%lf,%lf,%llu", &layout.low, &layout.high, &bins) !=
+           3) ||
+          !(layout.low < layout.high) || (bins == 0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      layout.enabled = true;
+      layout.bins = size_t(bins);
+      break;
+    }
+    case 'r':
+      ingest = true;
+      if (strcmp(optarg, "io_uring") == 0) {
+        method = number_ingest::read_method::io_uring;
+      } else if (strcmp(optarg, "pread") == 0) {
+        method = number_ingest::read_method::pread;
+      } else if (strcmp(optarg, "auto") != 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc - optind != 1) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  const char *input = argv[optind];
+  if (ingest) {
+    return ingest_stats(input, thread_count, layout, method);
+  }
+  int fd = open(input, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", input, strerror(errno));
+    return EXIT_FAILURE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    fprintf(stderr, "cannot read %s: %s\n", input, strerror(errno));
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  size_t size = size_t(st.st_size);
+  // mmap refuses empty mappings
+  static const char empty[1] = {'\0'};
+  const char *data = empty;
+  if (size > 0) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      fprintf(stderr, "cannot map %s: %s\n", input, strerror(errno));
+      close(fd);
+      return EXIT_FAILURE;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapping);
+  }
+  close(fd);
+  int status = print_stats(data, size, thread_count, layout);
+  if (size > 0) {
+    munmap(const_cast<char *>(data), size);
+  }
+  return status;
+}
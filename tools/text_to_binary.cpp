@@ -0,0 +1,289 @@
+// Converts a text file of numbers, one per line or in a few columns
+// separated by white space or commas, into raw little-endian binary64 or
+// binary32 values, in reading order (row-major for columns).
+//
+// usage: text_to_binary [-f] [-t <threads>] <input> <output>
+//   -f  write binary32 (float) values rather than binary64 values
+//   -t  number of threads (default: all cores)
+//
+// The input is mapped in memory and split between the threads at
+// separators. Each thread parses its part with parse_numbers, then writes
+// its values at their final offset in the output with large writes.
+// Numbers that cannot be parsed (including values too large for the
+// format) are written as NaN so that columns stay aligned, and counted.
+// Statistics go to stderr; the exit status is 1 if any number could not
+// be parsed.
+#include "fast_double_parser.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+// At most this many unparsable numbers are reported.
+const size_t reported_errors = 10;
+
+template <typename T> struct chunk {
+  const char *begin;
+  const char *end;
+  std::vector<T> values;
+  size_t error_count;
+  std::vector<const char *> errors;
+  uint64_t offset; // in the output, in values
+  bool write_failed;
+};
+
+template <typename T> void parse_chunk(chunk<T> *c) {
+  const size_t block = size_t(1) << 16;
+  const char *p = c->begin;
+  while (p != c->end) {
+    size_t old_size = c->values.size();
+    c->values.resize(old_size + block);
+    size_t count;
+    const char *stop = fast_double_parser::parse_numbers(
+        p, c->end, c->values.data() + old_size, block, &count);
+    c->values.resize(old_size + count);
+    p = stop;
+    if ((p == c->end) || (count == block)) {
+      continue;
+    }
+    // p is at a number that could not be parsed: we skip it
+    if (c->errors.size() < reported_errors) {
+      c->errors.push_back(p);
+    }
+    c->error_count++;
+    c->values.push_back(std::numeric_limits<T>::quiet_NaN());
+    while ((p != c->end) && !fast_double_parser::is_separator(*p)) {
+      p++;
+    }
+  }
+}
+
+bool is_little_endian() {
+  uint16_t x = 1;
+  unsigned char first;
+  memcpy(&first, &x, 1);
+  return first == 1;
+}
+
+template <typename T> void to_little_endian(std::vector<T> *values) {
+  if (is_little_endian()) {
+    return;
+  }
+  for (T &value : *values) {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T) / 2; i++) {
+      std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+    }
+    memcpy(&value, bytes, sizeof(T));
+  }
+}
+
+template <typename T> void write_chunk(int fd, chunk<T> *c) {
+  to_little_endian(&c->values);
+  const char *data = reinterpret_cast<const char *>(c->values.data());
+  size_t size = c->values.size() * sizeof(T);
+  off_t offset = off_t(c->offset * sizeof(T));
+  const size_t piece = size_t(1) << 22;
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, size < piece ? size : piece, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      c->write_failed = true;
+      return;
+    }
+    data += written;
+    size -= size_t(written);
+    offset += written;
+  }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// The 1-based line of position p in [begin, ...).
+size_t line_of(const char *begin, const char *p) {
+  size_t line = 1;
+  for (; begin != p; begin++) {
+    line += (*begin == '\n');
+  }
+  return line;
+}
+
+template <typename T>
+int convert(const char *data, size_t size, size_t thread_count,
+            const char *output) {
+  auto start = std::chrono::steady_clock::now();
+  // each part starts at a separator, or at the start of the input
+  std::vector<chunk<T>> chunks(thread_count);
+  const char *end = data + size;
+  const char *p = data;
+  for (size_t t = 0; t < thread_count; t++) {
+    const char *split = data + size * (t + 1) / thread_count;
+    if (split < p) {
+      split = p;
+    }
+    while ((split != end) && !fast_double_parser::is_separator(*split)) {
+      split++;
+    }
+    chunks[t].begin = p;
+    chunks[t].end = split;
+    chunks[t].error_count = 0;
+    chunks[t].write_failed = false;
+    p = split;
+  }
+  std::vector<std::thread> threads;
+  for (chunk<T> &c : chunks) {
+    threads.emplace_back(parse_chunk<T>, &c);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  double parse_time = seconds_since(start);
+
+  uint64_t total = 0;
+  size_t error_count = 0;
+  for (chunk<T> &c : chunks) {
+    c.offset = total;
+    total += c.values.size();
+    error_count += c.error_count;
+  }
+  auto write_start = std::chrono::steady_clock::now();
+  int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", output, strerror(errno));
+    return EXIT_FAILURE;
+  }
+  if (ftruncate(fd, off_t(total * sizeof(T))) != 0) {
+    fprintf(stderr, "cannot resize %s: %s\n", output, strerror(errno));
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  threads.clear();
+  for (chunk<T> &c : chunks) {
+    threads.emplace_back(write_chunk<T>, fd, &c);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  bool write_failed = false;
+  for (chunk<T> &c : chunks) {
+    write_failed |= c.write_failed;
+  }
+  if ((close(fd) != 0) || write_failed) {
+    fprintf(stderr, "cannot write %s\n", output);
+    return EXIT_FAILURE;
+  }
+  double write_time = seconds_since(write_start);
+  double total_time = seconds_since(start);
+
+  size_t reported = 0;
+  for (chunk<T> &c : chunks) {
+    for (const char *error : c.errors) {
+      if (reported == reported_errors) {
+        break;
+      }
+      reported++;
+      const char *token_end = error;
+      while ((token_end != end) && (token_end - error < 40) &&
+             !fast_double_parser::is_separator(*token_end)) {
+        token_end++;
+      }
+      fprintf(stderr, "line %zu: cannot parse '%.*s'\n",
+              line_of(data, error), int(token_end - error), error);
+    }
+  }
+  fprintf(stderr, "%zu bytes, %" PRIu64 " numbers, %zu errors, %zu threads\n",
+          size, total, error_count, thread_count);
+  fprintf(stderr, "parse: %.3f s, %.2f MB/s, %.2f Mnumbers/s\n", parse_time,
+          double(size) / parse_time / 1e6, double(total) / parse_time / 1e6);
+  fprintf(stderr, "write: %.3f s, %.2f MB/s (%" PRIu64 " bytes)\n",
+          write_time, double(total * sizeof(T)) / write_time / 1e6,
+          uint64_t(total * sizeof(T)));
+  fprintf(stderr, "total: %.3f s, %.2f MB/s\n", total_time,
+          double(size) / total_time / 1e6);
+  return error_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-f] [-t <threads>] <input> <output>\n", name);
+  fprintf(stderr, "  -f  write binary32 (float) values rather than binary64\n");
+  fprintf(stderr, "  -t  number of threads (default: all cores)\n");
+}
+
+int main(int argc, char **argv) {
+  bool single = false;
+  size_t thread_count = std::thread::hardware_concurrency();
+  int c;
+  while ((c = getopt(argc, argv, "ft:")) != -1) {
+    switch (c) {
+    case 'f':
+      single = true;
+      break;
+    case 't':
+      thread_count = size_t(strtoull(optarg, nullptr, 10));
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc - optind != 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  const char *input = argv[optind];
+  const char *output = argv[optind + 1];
+  int fd = open(input, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", input, strerror(errno));
+    return EXIT_FAILURE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    fprintf(stderr, "cannot read %s: %s\n", input, strerror(errno));
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  size_t size = size_t(st.st_size);
+  // mmap refuses empty mappings
+  static const char empty[1] = {'\0'};
+  const char *data = empty;
+  if (size > 0) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      fprintf(stderr, "cannot map %s: %s\n", input, strerror(errno));
+      close(fd);
+      return EXIT_FAILURE;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapping);
+  }
+  close(fd);
+  int status = single ? convert<float>(data, size, thread_count, output)
+                      : convert<double>(data, size, thread_count, output);
+  if (size > 0) {
+    munmap(const_cast<char *>(data), size);
+  }
+  return status;
+}